@@ -0,0 +1,114 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# include "allocations.hpp"
+
+# include <atomic>
+# include <cerrno>
+# include <cstdlib>
+# include <new>
+
+#if defined(__GLIBC__)
+# include <malloc.h>
+#endif
+
+namespace {
+  std::atomic<std::uint64_t> n_allocations{0};
+  std::atomic<std::uint64_t> n_bytes{0}, n_peak_bytes{0};
+
+  void count() {
+    n_allocations.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void track(const std::uint64_t allocated, const std::uint64_t released) {
+    const std::uint64_t bytes = n_bytes.fetch_add(allocated - released, std::memory_order_relaxed) + allocated - released;
+    std::uint64_t peak = n_peak_bytes.load(std::memory_order_relaxed);
+    while (bytes > peak && !n_peak_bytes.compare_exchange_weak(peak, bytes, std::memory_order_relaxed)) {}
+  }
+}
+
+namespace phgasnets::benchmarks {
+
+std::uint64_t allocation_count() {
+  return n_allocations.load(std::memory_order_relaxed);
+}
+
+std::uint64_t heap_bytes() {
+  return n_bytes.load(std::memory_order_relaxed);
+}
+
+std::uint64_t peak_heap_bytes() {
+  return n_peak_bytes.load(std::memory_order_relaxed);
+}
+
+void reset_peak_heap_bytes() {
+  n_peak_bytes.store(n_bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+}
+
+#if defined(__GLIBC__)
+
+// Eigen allocates through malloc directly, so the C allocation functions are wrapped,
+// forwarding to the glibc implementation. operator new allocates through malloc as well.
+// Heap bytes are those usable in each block, as reported by malloc_usable_size.
+extern "C" {
+  void* __libc_malloc(std::size_t size);
+  void* __libc_calloc(std::size_t n, std::size_t size);
+  void* __libc_realloc(void* ptr, std::size_t size);
+  void* __libc_memalign(std::size_t alignment, std::size_t size);
+  void  __libc_free(void* ptr);
+}
+
+namespace {
+  void* counted(void* ptr) {
+    count();
+    if (ptr)
+      track(malloc_usable_size(ptr), 0);
+    return ptr;
+  }
+}
+
+extern "C" {
+  void* malloc(std::size_t size) { return counted(__libc_malloc(size)); }
+  void* calloc(std::size_t n, std::size_t size) { return counted(__libc_calloc(n, size)); }
+  void* realloc(void* ptr, std::size_t size) {
+    const std::uint64_t released = ptr ? malloc_usable_size(ptr) : 0;
+    void* moved = __libc_realloc(ptr, size);
+    // A failed realloc keeps the original block
+    if (moved || size == 0)
+      track(0, released);
+    return counted(moved);
+  }
+  void* memalign(std::size_t alignment, std::size_t size) { return counted(__libc_memalign(alignment, size)); }
+  void* aligned_alloc(std::size_t alignment, std::size_t size) { return counted(__libc_memalign(alignment, size)); }
+  int posix_memalign(void** ptr, std::size_t alignment, std::size_t size) {
+    *ptr = counted(__libc_memalign(alignment, size));
+    return *ptr ? 0 : ENOMEM;
+  }
+  void free(void* ptr) {
+    if (ptr)
+      track(0, malloc_usable_size(ptr));
+    __libc_free(ptr);
+  }
+}
+
+#else
+
+// Elsewhere only C++ allocations are counted
+void* operator new(std::size_t size) {
+  count();
+  if (void* ptr = std::malloc(size ? size : 1))
+    return ptr;
+  throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+#endif
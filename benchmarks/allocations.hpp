@@ -0,0 +1,43 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# pragma once
+
+# include <cstdint>
+
+namespace phgasnets::benchmarks {
+
+  /**
+   * Number of heap allocations in the process so far.
+   *
+   * On glibc, these are the calls of malloc and its relatives, through which operator new
+   * and Eigen allocate. Elsewhere, only calls of the global operator new are counted.
+   */
+  std::uint64_t allocation_count();
+
+  /**
+   * Bytes currently allocated on the heap, and the most allocated at once since the last
+   * reset_peak_heap_bytes(). Only tracked on glibc, zero elsewhere.
+   */
+  std::uint64_t heap_bytes();
+  std::uint64_t peak_heap_bytes();
+
+  /**
+   * Restarts the peak at the bytes currently allocated, to measure a section of the process.
+   */
+  void reset_peak_heap_bytes();
+
+  /**
+   * Counts the heap allocations of a callable.
+   */
+  template <typename F>
+  std::uint64_t count_allocations(F&& f) {
+    const std::uint64_t before = allocation_count();
+    f();
+    return allocation_count() - before;
+  }
+
+}
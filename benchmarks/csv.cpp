@@ -0,0 +1,57 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# include <phgasnets>
+
+# include <benchmark/benchmark.h>
+# include <cstdio>
+# include <fstream>
+# include <iomanip>
+# include <string>
+
+namespace {
+  const std::string csv_filename = "phgasnets_benchmark.csv";
+
+  // Rows of the boundary CSV output: time, two pressures and two momenta
+  double value(const std::size_t row, const std::size_t column) {
+    return 8e6/(1.0 + row) + 463.33*column + 1e-3*row;
+  }
+}
+
+// Rows of 5 columns through CSVWriter, i.e. std::to_chars into a buffer
+static void BM_csv_writer(benchmark::State& state) {
+  const std::size_t n_rows = state.range(0);
+  for (auto _ : state) {
+    phgasnets::CSVWriter writer(csv_filename, {"time", "inletPressure", "outletPressure", "inletMomentum", "outletMomentum"});
+    for (std::size_t i = 0; i < n_rows; ++i)
+      writer.writeRow({value(i, 0), value(i, 1), value(i, 2), value(i, 3), value(i, 4)});
+    writer.flush();
+  }
+  state.SetItemsProcessed(state.iterations()*n_rows);
+  std::remove(csv_filename.c_str());
+}
+BENCHMARK(BM_csv_writer)->RangeMultiplier(16)->Range(1 << 12, 1 << 20)->Unit(benchmark::kMillisecond);
+
+// The same rows through an iostream with scientific formatting, as before CSVWriter
+static void BM_csv_iostream(benchmark::State& state) {
+  const std::size_t n_rows = state.range(0);
+  for (auto _ : state) {
+    std::ofstream file(csv_filename);
+    file << "time inletPressure outletPressure inletMomentum outletMomentum\n";
+    file << std::scientific << std::setprecision(6);
+    for (std::size_t i = 0; i < n_rows; ++i) {
+      for (std::size_t j = 0; j < 5; ++j) {
+        file << value(i, j);
+        if (j < 4)
+          file << " ";
+      }
+      file << "\n";
+    }
+  }
+  state.SetItemsProcessed(state.iterations()*n_rows);
+  std::remove(csv_filename.c_str());
+}
+BENCHMARK(BM_csv_iostream)->RangeMultiplier(16)->Range(1 << 12, 1 << 20)->Unit(benchmark::kMillisecond);
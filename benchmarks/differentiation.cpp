@@ -0,0 +1,79 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# include "fixture.hpp"
+
+# include <benchmark/benchmark.h>
+
+using phgasnets::benchmarks::BenchmarkNetwork;
+using phgasnets::Differentiation;
+
+namespace {
+  // Differentiations compared, indexed by the first benchmark argument
+  constexpr Differentiation differentiations[] = {
+    Differentiation::Automatic,
+    Differentiation::ForwardDifference,
+    Differentiation::CentralDifference
+  };
+
+  // Steady state at the operating point, then the input after a 10% increase of the outlet momentum
+  void perturbed_operating_point(BenchmarkNetwork& bench, Eigen::VectorXd& steady_state, Eigen::Vector4d& input) {
+    phgasnets::Simulator simulator(bench.network, bench.disc_params, Differentiation::Automatic);
+    simulator.input() = bench.input;
+    simulator.initialize(bench.state);
+    steady_state = simulator.state();
+    input = bench.input;
+    input(3) *= 1.1;
+  }
+}
+
+// One implicit midpoint step after a 10% increase of the outlet momentum, for each differentiation.
+// The solution difference is relative to the step with automatic differentiation.
+static void BM_differentiation(benchmark::State& state) {
+  const Differentiation differentiation = differentiations[state.range(0)];
+  const int Nx = state.range(1);
+  const double dt = 100.0;
+  BenchmarkNetwork bench(Nx);
+
+  Eigen::VectorXd steady_state;
+  Eigen::Vector4d input;
+  perturbed_operating_point(bench, steady_state, input);
+
+  phgasnets::Simulator reference(bench.network, bench.disc_params, Differentiation::Automatic);
+  reference.set_state(steady_state);
+  reference.input() = input;
+  reference.step(dt);
+
+  phgasnets::Simulator simulator(bench.network, bench.disc_params, differentiation);
+  simulator.input() = input;
+
+  double jacobian_time = 0.0, solve_time = 0.0;
+  int jacobian_evaluations = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    simulator.set_state(steady_state);
+    state.ResumeTiming();
+
+    const auto& summary = simulator.step(dt);
+    jacobian_time        += summary.jacobian_evaluation_time_in_seconds;
+    jacobian_evaluations += summary.num_jacobian_evaluations;
+    solve_time           += summary.total_time_in_seconds;
+  }
+
+  const auto& summary = simulator.summary;
+  const Eigen::VectorXd& solution = reference.state();
+  state.SetLabel(phgasnets::to_string(differentiation));
+  state.counters["dofs"]         = steady_state.size();
+  state.counters["iterations"]   = summary.iterations.size();
+  state.counters["jacobian_us"]  = 1e6*jacobian_time/std::max(jacobian_evaluations, 1);
+  state.counters["solve_ms"]     = 1e3*solve_time/state.iterations();
+  state.counters["max_rel_diff"] = ((simulator.state() - solution).cwiseAbs().array()
+                                     / solution.cwiseAbs().array().max(1e-12)).maxCoeff();
+}
+BENCHMARK(BM_differentiation)
+  ->ArgsProduct({{0, 1, 2}, {16, 64, 256, 1024}})
+  ->ArgNames({"mode", "Nx"})
+  ->Unit(benchmark::kMillisecond);
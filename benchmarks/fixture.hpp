@@ -0,0 +1,59 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# pragma once
+
+# include <phgasnets>
+
+# include <vector>
+# include <Eigen/Core>
+# include <nlohmann/json.hpp>
+
+namespace phgasnets::benchmarks {
+
+  /**
+   * The two-pipe network of the four_compressor_types demo (FC/AV), at a given resolution,
+   * with a constant state near its operating point.
+   */
+  struct BenchmarkNetwork {
+      BenchmarkNetwork(const int Nx) :
+        compressors({Compressor("FC", "AV", 1.2, 1.4)}),
+        pipes({
+          Pipe(181500, 1.422, 1.8e-3, inlet_temperature),
+          Pipe(181500, 1.422, 1.8e-3, inlet_temperature*compressors[0].temperature_scale)
+        }),
+        network(pipes, compressors, Fluid(530.0)),
+        disc_params({
+          {"space", {{"resolution", Nx}, {"order", 1}}},
+          {"time", {{"start", 0}, {"end", 24}, {"step", 100}}}
+        }),
+        Nx(Nx)
+      {
+        compressors[0].update_compression_ratio(1.2);
+
+        const double p0 = 8e6, mom0 = 463.33;
+        state.resize(4*(Nx+1));
+        state.segment(0, Nx+1).setConstant(p0/network.RT(0));
+        state.segment(Nx+1, Nx+1).setConstant(mom0/compressors[0].momentum_scale);
+        state.segment(2*(Nx+1), Nx+1).setConstant(p0*1.2/network.RT(1));
+        state.segment(3*(Nx+1), Nx+1).setConstant(mom0);
+
+        input = Eigen::Vector4d(p0, 1.0/std::pow(1.2, 1/1.4), 1.2, -mom0);
+      }
+
+      public:
+        static constexpr double inlet_temperature = 276.25;
+
+        std::vector<Compressor> compressors;
+        std::vector<Pipe> pipes;
+        const Network network;
+        const nlohmann::json disc_params;
+        const int Nx;
+        Eigen::VectorXd state;
+        Eigen::Vector4d input;
+  };
+
+}
@@ -0,0 +1,104 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# include "fixture.hpp"
+# include "allocations.hpp"
+
+# include <filesystem>
+# include <string>
+# include <benchmark/benchmark.h>
+
+using phgasnets::benchmarks::BenchmarkNetwork;
+using phgasnets::benchmarks::count_allocations;
+
+// Construction of the static operators of one pipe
+static void BM_J_operator(benchmark::State& state) {
+  const int Nx = state.range(0);
+  for (auto _ : state) {
+    phgasnets::J_operator J(Nx+1, Nx+1, 181500.0/Nx);
+    benchmark::DoNotOptimize(J.mat.valuePtr());
+  }
+  state.SetComplexityN(Nx);
+}
+BENCHMARK(BM_J_operator)->RangeMultiplier(8)->Range(16, 100000)->Complexity();
+
+static void BM_Jt_operator(benchmark::State& state) {
+  const int Nx = state.range(0);
+  for (auto _ : state) {
+    phgasnets::Jt_operator Jt(Nx+1, Nx+1, 181500.0/Nx);
+    benchmark::DoNotOptimize(Jt.mat.valuePtr());
+  }
+  state.SetComplexityN(Nx);
+}
+BENCHMARK(BM_Jt_operator)->RangeMultiplier(8)->Range(16, 100000)->Complexity();
+
+// Assembly of the network friction operator from its pipe blocks, as on every residual evaluation
+static void BM_diagonalBlock(benchmark::State& state) {
+  const int Nx = state.range(0);
+  BenchmarkNetwork bench(Nx);
+  auto discrete_network = phgasnets::discretize<double>(bench.network, bench.disc_params["space"]);
+  discrete_network.set_state(bench.state);
+
+  std::vector<std::reference_wrapper<phgasnets::BaseOperator<double>>> operators_r;
+  for (auto& pipe : discrete_network.pipes)
+    operators_r.push_back(std::ref(pipe.Rt));
+
+  for (auto _ : state) {
+    auto R = phgasnets::diagonalBlock<double>(operators_r);
+    benchmark::DoNotOptimize(R.valuePtr());
+  }
+  state.SetComplexityN(Nx);
+}
+BENCHMARK(BM_diagonalBlock)->RangeMultiplier(8)->Range(16, 100000)->Complexity();
+
+// Update of the state-dependent operators and effort of the whole network
+static void BM_set_state(benchmark::State& state) {
+  const int Nx = state.range(0);
+  BenchmarkNetwork bench(Nx);
+  auto discrete_network = phgasnets::discretize<double>(bench.network, bench.disc_params["space"]);
+
+  if (count_allocations([&] { discrete_network.set_state(bench.state); }) > 0) {
+    state.SkipWithError("set_state allocates on the heap");
+    return;
+  }
+
+  for (auto _ : state) {
+    discrete_network.set_state(bench.state);
+    benchmark::DoNotOptimize(discrete_network.effort.data());
+  }
+  state.SetComplexityN(Nx);
+}
+BENCHMARK(BM_set_state)->RangeMultiplier(8)->Range(16, 100000)->Complexity();
+
+// Discretization of the network at startup, assembling all operators
+static void BM_discretize(benchmark::State& state) {
+  const int Nx = state.range(0);
+  BenchmarkNetwork bench(Nx);
+
+  for (auto _ : state) {
+    auto discrete_network = phgasnets::discretize<double>(bench.network, bench.disc_params["space"]);
+    benchmark::DoNotOptimize(discrete_network.J.valuePtr());
+  }
+  state.SetComplexityN(Nx);
+}
+BENCHMARK(BM_discretize)->RangeMultiplier(8)->Range(16, 100000)->Complexity();
+
+// Discretization of the network restored from a snapshot, adopting the static operators of its pipes
+static void BM_discretize_snapshot(benchmark::State& state) {
+  const int Nx = state.range(0);
+  BenchmarkNetwork bench(Nx);
+  const std::string filename = (std::filesystem::temp_directory_path() / "phgasnets_benchmark_snapshot.bin").string();
+  phgasnets::writeNetworkSnapshot(filename, bench.network, bench.disc_params["space"]);
+
+  for (auto _ : state) {
+    phgasnets::NetworkSnapshot snapshot(filename);
+    auto discrete_network = phgasnets::discretize<double>(snapshot.network(), snapshot.spatial_disc_params);
+    benchmark::DoNotOptimize(discrete_network.J.valuePtr());
+  }
+  std::filesystem::remove(filename);
+  state.SetComplexityN(Nx);
+}
+BENCHMARK(BM_discretize_snapshot)->RangeMultiplier(8)->Range(16, 100000)->Complexity();
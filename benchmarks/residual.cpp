@@ -0,0 +1,111 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# include "fixture.hpp"
+# include "allocations.hpp"
+
+# include <benchmark/benchmark.h>
+# include <ceres/ceres.h>
+
+using phgasnets::benchmarks::BenchmarkNetwork;
+using phgasnets::benchmarks::count_allocations;
+
+namespace {
+  // Jet size used by the dynamic autodiff cost function of the simulator
+  constexpr int stride = 4;
+  using Jet = ceres::Jet<double, stride>;
+}
+
+// One residual evaluation of the transient system, with double or Jet scalars
+template <typename T>
+static void BM_residual(benchmark::State& state) {
+  const int Nx = state.range(0);
+  BenchmarkNetwork bench(Nx);
+  const double time = 0.0, dt = 100.0;
+  phgasnets::TransientCompressorSystem system(
+    bench.network, bench.disc_params, bench.state, bench.input, time, dt
+  );
+
+  // Seed the first derivative directions, as one autodiff pass does
+  std::vector<T> guess(bench.state.size()), residual(bench.state.size()+4);
+  for (int i = 0; i < bench.state.size(); ++i)
+    guess[i] = T(bench.state(i));
+  if constexpr (!std::is_same_v<T, double>) {
+    for (int k = 0; k < stride; ++k)
+      guess[k].v[k] = 1.0;
+  }
+  const T* parameters = guess.data();
+
+  // The first call discretizes the network, after which evaluations must not allocate
+  system(&parameters, residual.data());
+  const auto allocations = count_allocations([&] { system(&parameters, residual.data()); });
+  if (allocations > 0) {
+    state.SkipWithError("residual evaluation allocates on the heap");
+    return;
+  }
+
+  for (auto _ : state) {
+    system(&parameters, residual.data());
+    benchmark::DoNotOptimize(residual.data());
+  }
+  state.SetComplexityN(Nx);
+}
+BENCHMARK_TEMPLATE(BM_residual, double)->RangeMultiplier(8)->Range(16, 100000)->Complexity();
+BENCHMARK_TEMPLATE(BM_residual, Jet)->RangeMultiplier(8)->Range(16, 100000)->Complexity();
+
+// Residual and dense Jacobian through the cost function used by the simulator,
+// limited in size as the Jacobian is dense
+static void BM_jacobian(benchmark::State& state) {
+  const int Nx = state.range(0);
+  BenchmarkNetwork bench(Nx);
+  const double time = 0.0, dt = 100.0;
+  const int n_state = bench.state.size(), n_res = n_state+4;
+
+  ceres::DynamicAutoDiffCostFunction<phgasnets::TransientCompressorSystem, stride> cost_function(
+    new phgasnets::TransientCompressorSystem(bench.network, bench.disc_params, bench.state, bench.input, time, dt)
+  );
+  cost_function.AddParameterBlock(n_state);
+  cost_function.SetNumResiduals(n_res);
+
+  std::vector<double> residual(n_res), jacobian(std::size_t(n_res)*n_state);
+  const double* parameters = bench.state.data();
+  double* jacobians = jacobian.data();
+  cost_function.Evaluate(&parameters, residual.data(), nullptr);
+
+  // Allocations of the cost function itself, e.g. its Jet buffers, are reported but not enforced
+  state.counters["allocations"] = count_allocations([&] {
+    cost_function.Evaluate(&parameters, residual.data(), &jacobians);
+  });
+
+  for (auto _ : state) {
+    cost_function.Evaluate(&parameters, residual.data(), &jacobians);
+    benchmark::DoNotOptimize(jacobian.data());
+  }
+  state.SetComplexityN(Nx);
+}
+BENCHMARK(BM_jacobian)->RangeMultiplier(4)->Range(16, 1024)->Complexity();
+
+// One full implicit midpoint step, including the nonlinear solve
+static void BM_step(benchmark::State& state) {
+  const int Nx = state.range(0);
+  BenchmarkNetwork bench(Nx);
+
+  phgasnets::Simulator simulator(bench.network, bench.disc_params);
+  simulator.input() = bench.input;
+  simulator.initialize(bench.state);
+  const auto baseline = simulator.checkpoint();
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    simulator.initialize(baseline);
+    state.ResumeTiming();
+
+    simulator.step(100.0);
+    state.counters["iterations"] = simulator.summary.iterations.size();
+  }
+  state.SetComplexityN(Nx);
+}
+BENCHMARK(BM_step)->RangeMultiplier(4)->Range(16, 1024)->Complexity()->Unit(benchmark::kMillisecond);
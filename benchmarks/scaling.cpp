@@ -0,0 +1,89 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# include "allocations.hpp"
+
+# include <phgasnets>
+
+# include <benchmark/benchmark.h>
+# include <ceres/ceres.h>
+
+namespace {
+  // Largest state dimension benchmarked, as the Jacobian of the single residual block is dense
+  constexpr int max_dofs = 10000;
+
+  // Number of pipes and resolution, within the state dimension limit
+  void chain_sizes(benchmark::internal::Benchmark* benchmark) {
+    for (int n_pipes : {2, 8, 32, 128, 512})
+      for (int Nx : {16, 64, 256})
+        if (n_pipes*(2*Nx+2) <= max_dofs)
+          benchmark->Args({n_pipes, Nx});
+  }
+}
+
+// One implicit midpoint step of a synthetic compressor chain, after a 10% increase of the outlet momentum
+static void BM_chain_step(benchmark::State& state) {
+  const int n_pipes = state.range(0), Nx = state.range(1);
+
+  // Heap of this configuration only, from setup through the last solve
+  const double heap_before = phgasnets::benchmarks::heap_bytes();
+  phgasnets::benchmarks::reset_peak_heap_bytes();
+
+  phgasnets::SyntheticChain chain(n_pipes, {{"gas_constant", 530.0}});
+  const nlohmann::json disc_params = {
+    {"space", {{"resolution", Nx}, {"order", 1}}},
+    {"time", {{"start", 0}, {"end", 24}, {"step", 100}}}
+  };
+  const int n_state = n_pipes*(2*Nx+2), n_res = n_pipes*(2*Nx+4);
+
+  ceres::Solver::Options options;
+  options.function_tolerance = 1e-12;
+  options.max_num_iterations = 2000;
+  ceres::Solver::Summary summary;
+
+  // Steady state
+  Eigen::VectorXd steady_state = chain.initial_guess(Nx);
+  {
+    ceres::Problem problem;
+    auto cost_function = new ceres::DynamicAutoDiffCostFunction<phgasnets::SteadyCompressorSystem>(
+      new phgasnets::SteadyCompressorSystem(chain.network, disc_params["space"], chain.input)
+    );
+    cost_function->AddParameterBlock(n_state);
+    cost_function->SetNumResiduals(n_res);
+    problem.AddResidualBlock(cost_function, nullptr, steady_state.data());
+    ceres::Solve(options, &problem, &summary);
+  }
+
+  // Transient step
+  Eigen::VectorXd current_state = steady_state, guess = steady_state;
+  Eigen::VectorXd input = chain.input;
+  input(input.size()-1) *= 1.1;
+  const double time = 100.0, dt = 100.0;
+
+  ceres::Problem problem;
+  auto cost_function = new ceres::DynamicAutoDiffCostFunction<phgasnets::TransientCompressorSystem>(
+    new phgasnets::TransientCompressorSystem(chain.network, disc_params, current_state, input, time, dt)
+  );
+  cost_function->AddParameterBlock(n_state);
+  cost_function->SetNumResiduals(n_res);
+  problem.AddResidualBlock(cost_function, nullptr, guess.data());
+
+  int iterations = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    guess = steady_state;
+    state.ResumeTiming();
+
+    ceres::Solve(options, &problem, &summary);
+    iterations += summary.iterations.size();
+  }
+
+  state.counters["dofs"]        = n_state;
+  state.counters["iterations"]  = benchmark::Counter(iterations, benchmark::Counter::kAvgIterations);
+  state.counters["jacobian_MB"] = double(n_res)*n_state*sizeof(double) / (1024.0*1024.0);
+  state.counters["peak_heap_MB"] = (phgasnets::benchmarks::peak_heap_bytes() - heap_before) / (1024.0*1024.0);
+}
+BENCHMARK(BM_chain_step)->Apply(chain_sizes)->ArgNames({"pipes", "Nx"})->Unit(benchmark::kMillisecond);
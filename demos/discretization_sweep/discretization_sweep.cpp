@@ -0,0 +1,215 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# include <algorithm>
+# include <cstdio>
+# include <iostream>
+# include <fstream>
+# include <thread>
+# include <cxxopts.hpp>
+# include <Eigen/Dense>
+# include <nlohmann/json.hpp>
+# include <phgasnets>
+
+// Define the json library
+using json = nlohmann::json;
+
+// Outlet momentum of the four_compressor_types testcase, as a piecewise linear profile with jumps
+const double initial_momentum = 463.33;
+
+json momentum_at_outlet(const double horizon) {
+  json profile = {{0.0, initial_momentum}};
+  const double hours[]    = {6, 12, 18};
+  const double momentum[] = {540.55, 386.11, 463.33};
+  for (int k = 0; k < 3; ++k) {
+    if (hours[k]*3600 >= horizon)
+      break;
+    profile.push_back({hours[k]*3600, profile.back()[1]});
+    profile.push_back({hours[k]*3600, momentum[k]});
+  }
+  return profile;
+}
+
+int main(int argc, char** argv){
+
+  cxxopts::Options parser("discretization_sweep", "Accuracy against runtime over a grid of resolutions and time step sizes");
+  parser.add_options()
+    (
+      "c,config",
+      "Path to the <config-file>.json",
+      cxxopts::value<std::string>()
+        ->default_value("config.json")
+    )
+    (
+      "resolutions",
+      "Comma-separated numbers of cells per pipe",
+      cxxopts::value<std::vector<int>>()
+        ->default_value("4,8,16,32")
+    )
+    (
+      "steps",
+      "Comma-separated time step sizes [s]",
+      cxxopts::value<std::vector<double>>()
+        ->default_value("1800,900,300,100")
+    )
+    (
+      "reference-resolution",
+      "Resolution of the reference, twice the finest by default",
+      cxxopts::value<int>()
+    )
+    (
+      "reference-step",
+      "Time step size of the reference [s], half the smallest by default",
+      cxxopts::value<double>()
+    )
+    (
+      "horizon",
+      "Simulated time [h], from the configuration by default",
+      cxxopts::value<double>()
+    )
+    (
+      "tolerance",
+      "Relative error the cheapest setting has to meet",
+      cxxopts::value<double>()
+    )
+    (
+      "j,threads",
+      "Number of settings run in parallel",
+      cxxopts::value<int>()
+        ->default_value(std::to_string(std::max(1u, std::thread::hardware_concurrency())))
+    )
+    (
+      "o,output",
+      "Path to a <results-file>.json",
+      cxxopts::value<std::string>()
+    )
+    ("h,help", "Print usage")
+    ;
+
+  cxxopts::ParseResult args;
+  try {
+    args = parser.parse(argc, argv);
+  }
+  catch (const cxxopts::exceptions::exception& err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << parser.help() << std::endl;
+    std::exit(1);
+  }
+
+  if (args.count("help")) {
+    std::cout << parser.help() << std::endl;
+    return 0;
+  }
+
+  // Read the JSON file
+  std::ifstream config_file(args["config"].as<std::string>());
+  json config = json::parse(config_file);
+
+  const double inlet_temperature = config["boundary_conditions"]["inlet"]["temperature"].get<double>();
+  const double inlet_pressure    = config["boundary_conditions"]["inlet"]["pressure"].get<double>();
+  const double compr_spec        = config["compressor"]["specification"].get<double>();
+  const double kappa             = config["fluid"]["isentropic_exponent"].get<double>();
+
+  // Gas transported by the network
+  const phgasnets::Fluid fluid = phgasnets::fluidFromJson(config["fluid"], config["GAS_CONSTANT"].get<double>());
+
+  // Make Pipes and Compressor objects
+  std::vector<phgasnets::Compressor> compressors = {
+        phgasnets::Compressor(config["compressor"], kappa)
+  };
+
+  const double outlet_temperature = inlet_temperature * compressors[0].temperature_scale;
+
+  std::vector<phgasnets::Pipe> pipes = {
+    phgasnets::Pipe(config["pipe"], inlet_temperature),
+    phgasnets::Pipe(config["pipe"], outlet_temperature)
+  };
+
+  const double p0 = config["initial_conditions"]["pressure"].get<double>();
+  if (compressors[0].type == "FP") {
+    compressors[0].update_compression_ratio(compr_spec/p0);
+  }
+  else if (compressors[0].type == "FC") {
+    compressors[0].update_compression_ratio(compr_spec);
+  }
+
+  phgasnets::Network net = phgasnets::Network(pipes, compressors, fluid);
+
+  // Steady state input
+  Eigen::Vector4d u_b(inlet_pressure, 1.0, compressors[0].specification, -initial_momentum);
+  if (compressors[0].model == "AV") {
+    u_b(1) = 1.0/std::pow(compressors[0].specification, 1/compressors[0].isentropic_exponent);
+  }
+
+  // Grid of settings and reference
+  const auto resolutions = args["resolutions"].as<std::vector<int>>();
+  const auto steps       = args["steps"].as<std::vector<double>>();
+
+  std::vector<phgasnets::SweepPoint> grid;
+  for (const int Nx : resolutions)
+    for (const double dt : steps)
+      grid.push_back({Nx, dt});
+
+  const phgasnets::SweepPoint reference = {
+    args.count("reference-resolution") ? args["reference-resolution"].as<int>() : 2*(*std::max_element(resolutions.begin(), resolutions.end())),
+    args.count("reference-step") ? args["reference-step"].as<double>() : 0.5*(*std::min_element(steps.begin(), steps.end()))
+  };
+
+  const auto& time_params = config["discretization"]["time"];
+  const double horizon = 3600*(args.count("horizon") ? args["horizon"].as<double>()
+    : time_params["end"].get<double>() - time_params["start"].get<double>());
+  const json scenario = {
+    {"horizon", horizon},
+    {"inlet_pressure", inlet_pressure},
+    {"outlet_momentum", momentum_at_outlet(horizon)}
+  };
+
+  std::cout << "Sweeping " << grid.size() << " settings against Nx = " << reference.resolution
+            << ", dt = " << reference.timestep << "s over " << horizon/3600 << "h" << std::endl;
+
+  const auto results = phgasnets::sweepDiscretizations(
+    net, config["discretization"], u_b, scenario, grid, reference, args["threads"].as<int>()
+  );
+
+  // Table of all settings by runtime, Pareto optimal ones marked
+  std::vector<phgasnets::SweepResult> by_runtime = results;
+  std::sort(by_runtime.begin(), by_runtime.end(), [](const auto& a, const auto& b) { return a.runtime < b.runtime; });
+
+  std::printf("%6s %8s %12s %10s %16s %16s %7s\n", "Nx", "dt [s]", "runtime [s]", "iterations", "pressure error", "momentum error", "pareto");
+  for (const auto& result : by_runtime) {
+    std::printf("%6d %8g %12.3f %10d %16.3e %16.3e %7s%s\n",
+      result.resolution, result.timestep, result.runtime, result.iterations,
+      result.pressure_error, result.momentum_error, result.pareto ? "*" : "",
+      result.converged ? "" : (result.steady_termination != "CONVERGENCE" ? " (steady state not converged)" : " (not converged)"));
+  }
+
+  if (args.count("tolerance")) {
+    const double tolerance = args["tolerance"].as<double>();
+    auto cheapest = std::find_if(by_runtime.begin(), by_runtime.end(), [tolerance](const auto& result) {
+      return result.converged && std::max(result.pressure_error, result.momentum_error) <= tolerance;
+    });
+    if (cheapest == by_runtime.end())
+      std::cout << "No setting meets the tolerance " << tolerance << std::endl;
+    else
+      std::cout << "Cheapest setting within " << tolerance << ": Nx = " << cheapest->resolution
+                << ", dt = " << cheapest->timestep << "s" << std::endl;
+  }
+
+  if (args.count("output")) {
+    json output = {
+      {"reference", {{"resolution", reference.resolution}, {"timestep", reference.timestep}}},
+      {"horizon", horizon},
+      {"results", json::array()}
+    };
+    for (const auto& result : results)
+      output["results"].push_back(result.to_json());
+    std::ofstream(args["output"].as<std::string>()) << output.dump(2) << std::endl;
+    std::cout << "Results written in [" << args["output"].as<std::string>() << "]" << std::endl;
+  }
+
+  return 0;
+
+}
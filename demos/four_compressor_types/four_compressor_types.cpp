@@ -4,9 +4,14 @@
 //
 // SPDX-License-Identifier:  GPL-3.0-or-later
 
+# include <algorithm>
 # include <iostream>
 # include <fstream>
 # include <array>
+# include <filesystem>
+# include <memory>
+# include <stdexcept>
+# include <string>
 # include <cxxopts.hpp>
 # include <Eigen/Dense>
 # include <Eigen/Sparse>
@@ -23,21 +28,6 @@ typedef Eigen::Vector2d Vector2d;
 typedef Eigen::VectorXd Vector;
 typedef Eigen::SparseMatrix<double> SparseMatrix;
 
-typedef ceres::Solver Solver;
-typedef ceres::Problem Problem;
-typedef ceres::CostFunction CostFunction;
-
-// Switch between numeric and auto differentiation
-#if PHGASNETS_NUMERICDIFF
-#pragma message("Using NumericDiff")
-template<typename T>
-  using DynamicDiffCostFunction = ceres::DynamicNumericDiffCostFunction<T>;
-#else
-#pragma message("Using AutoDiff")
-  template<typename T>
-    using DynamicDiffCostFunction = ceres::DynamicAutoDiffCostFunction<T>;
-#endif
-
 double momentum_at_outlet(double time) {
   if (time < 6*3600) {
       return 463.33;
@@ -71,6 +61,43 @@ int main(int argc, char** argv){
         ->default_value("false")
         ->implicit_value("true")
     )
+    (
+      "steady-cache",
+      "Directory of the steady state cache",
+      cxxopts::value<std::string>()
+    )
+    (
+      "snapshot",
+      "Path to a <snapshot-file>.bin of the discretized network, written if missing",
+      cxxopts::value<std::string>()
+    )
+    (
+      "feed",
+      "Name of a shared memory live state feed, e.g. /phgasnets",
+      cxxopts::value<std::string>()
+    )
+    (
+      "compare",
+      "Path to a reference <results-file>.h5 to compare the states against",
+      cxxopts::value<std::string>()
+    )
+    (
+      "r,restart",
+      "Path to a <checkpoint-file>.h5 to resume from",
+      cxxopts::value<std::string>()
+    )
+    (
+      "memory",
+      "Flag to print the memory footprint after the steady state",
+      cxxopts::value<bool>()
+        ->default_value("false")
+        ->implicit_value("true")
+    )
+    (
+      "trace",
+      "Path to a <trace-file>.json timeline, requires tracing compiled in",
+      cxxopts::value<std::string>()
+    )
     ("h,help", "Print usage")
     ;
 
@@ -93,14 +120,22 @@ int main(int argc, char** argv){
   std::ifstream config_file(args["config"].as<std::string>());
   json config = json::parse(config_file);
 
+  // Timeline of discretization, solves and writes (optional)
+  if (args.count("trace")) {
+    if (!PHGASNETS_TRACING) {
+      std::cerr << "Tracing is not compiled in, configure with -DPHGASNETS_TRACING=ON" << std::endl;
+    }
+    phgasnets::startTracing();
+  }
+
   const double inlet_temperature = config["boundary_conditions"]["inlet"]["temperature"].get<double>();
   const double inlet_pressure    = config["boundary_conditions"]["inlet"]["pressure"].get<double>();
   const double compr_spec        = config["compressor"]["specification"].get<double>();
   const double kappa             = config["fluid"]["isentropic_exponent"].get<double>();
   const int    Nx                = config["discretization"]["space"]["resolution"].get<int>();
 
-  // Set model-wide constants
-  phgasnets::set_gas_constant(config["GAS_CONSTANT"]);
+  // Gas transported by the network
+  const phgasnets::Fluid fluid = phgasnets::fluidFromJson(config["fluid"], config["GAS_CONSTANT"].get<double>());
 
   // // Make Pipes and Compressor objects
   std::vector<phgasnets::Compressor> compressors = {
@@ -114,31 +149,43 @@ int main(int argc, char** argv){
     phgasnets::Pipe(config["pipe"], outlet_temperature)
   };
 
-  phgasnets::Network net = phgasnets::Network(pipes, compressors);
+  const double p0   = config["initial_conditions"]["pressure"].get<double>();
+  const double mom0 = config["initial_conditions"]["momentum"].get<double>();
+
+  const double momentum_scale = compressors[0].momentum_scale;
+  if (compressors[0].type == "FP") {
+    compressors[0].update_compression_ratio(compr_spec/p0);
+  }
+  else if (compressors[0].type == "FC") {
+    compressors[0].update_compression_ratio(compr_spec);
+  }
+
+  phgasnets::Network net = phgasnets::Network(pipes, compressors, fluid);
+
+  // Adopt the static operators of a network snapshot instead of assembling them (optional)
+  if (args.count("snapshot")) {
+    const std::string snapshot_file = args["snapshot"].as<std::string>();
+    if (!std::filesystem::exists(snapshot_file)) {
+      phgasnets::writeNetworkSnapshot(snapshot_file, net, config["discretization"]["space"]);
+    }
+    phgasnets::NetworkSnapshot(snapshot_file).adoptOperators(net);
+  }
 
-  auto network = phgasnets::discretize<double>(net, config["discretization"]["space"]);
+  phgasnets::Simulator simulator(net, config["discretization"]);
+  const auto& network = simulator.discrete_network();
 
   // ------------------------------------------------------------------------
   auto t1 = high_resolution_clock::now();
 
   // Steady State Solve
-  const double p0   = config["initial_conditions"]["pressure"].get<double>();
-  const double mom0 = config["initial_conditions"]["momentum"].get<double>();
 
   // initial guess
   Vector pipeL_init_density(Nx+1), pipeL_init_momentum(Nx+1);
-  pipeL_init_density.setConstant(p0/(phgasnets::GAS_CONSTANT*inlet_temperature));
-  pipeL_init_momentum.setConstant(mom0/network.compressors[0].momentum_scale);
-
-  if (network.compressors[0].type == "FP") {
-    network.compressors[0].update_compression_ratio(compr_spec/p0);
-  }
-  else if (network.compressors[0].type == "FC") {
-    network.compressors[0].update_compression_ratio(compr_spec);
-  }
+  pipeL_init_density.setConstant(fluid.density(p0, inlet_temperature));
+  pipeL_init_momentum.setConstant(mom0/momentum_scale);
 
   Vector pipeR_init_density(Nx+1), pipeR_init_momentum(Nx+1);
-  pipeR_init_density.setConstant(p0*network.compressors[0].compression_ratio/(phgasnets::GAS_CONSTANT*outlet_temperature));
+  pipeR_init_density.setConstant(fluid.density(p0*compressors[0].compression_ratio, outlet_temperature));
   pipeR_init_momentum.setConstant(mom0);
 
   Vector init_state = phgasnets::verticallyBlockVectors({
@@ -147,176 +194,295 @@ int main(int argc, char** argv){
   });
 
   // boundary conditions
-  Eigen::Vector4d u_b({
+  Eigen::Vector4d& u_b = simulator.input();
+  u_b = Eigen::Vector4d({
     inlet_pressure,
     0.0,
-    network.compressors[0].specification,
+    compressors[0].specification,
     -momentum_at_outlet(0.0)
   });
 
-  if (network.compressors[0].model == "AV") {
-    u_b(1) = 1.0/std::pow(network.compressors[0].specification, 1/network.compressors[0].isentropic_exponent);
+  if (compressors[0].model == "AV") {
+    u_b(1) = 1.0/std::pow(compressors[0].specification, 1/compressors[0].isentropic_exponent);
   }
-  else if (network.compressors[0].model == "AM") {
+  else if (compressors[0].model == "AM") {
     u_b(1) = 1.0;
   }
 
-  // configure solver
-  Problem problem_steady;
-  auto cost_function_steady = new DynamicDiffCostFunction<phgasnets::SteadyCompressorSystem>(
-      new phgasnets::SteadyCompressorSystem(net, config["discretization"]["space"], u_b)
-  );
-
-  cost_function_steady->AddParameterBlock(network.n_state);
-  cost_function_steady->SetNumResiduals(network.n_res);
-
-  problem_steady.AddResidualBlock(cost_function_steady, nullptr, init_state.data());
+  // Resume from a checkpoint or compute the steady state
+  const bool restart = args.count("restart");
+
+  if (restart) {
+    auto checkpoint = phgasnets::readCheckpoint(args["restart"].as<std::string>());
+    // Step indices of the results continue those of the checkpoint, at the same step size
+    const double dt = config["discretization"]["time"]["step"].get<double>();
+    if (checkpoint.timestep != dt)
+      throw std::invalid_argument(
+        "Checkpoint time step " + std::to_string(checkpoint.timestep)
+        + "s does not match the configured time step " + std::to_string(dt) + "s"
+      );
+    simulator.initialize(checkpoint);
+    std::cout << "Restarting from t = " << checkpoint.time << "s\n";
+  }
+  else if (args.count("steady-cache")) {
+    // Warm start from the nearest cached steady state, skip the solve on an exact hit
+    phgasnets::SteadyStateCache steady_cache(
+      args["steady-cache"].as<std::string>(), net, config["discretization"]["space"]
+    );
+    double distance;
+    const bool cached = steady_cache.lookup(u_b, init_state, distance);
+    if (cached) {
+      std::cout << "Steady state cache: nearest operating point at relative distance " << distance << "\n";
+    }
+    if (cached && distance < 1e-12) {
+      simulator.set_state(init_state);
+    }
+    else {
+      // Only converged states may warm start later runs
+      if (simulator.initialize(init_state).termination_type == ceres::CONVERGENCE)
+        steady_cache.store(u_b, simulator.state());
+    }
+  }
+  else {
+    simulator.initialize(init_state);
+  }
 
-  // Set CERES Solver Options
-  Solver::Summary summary;
-  Solver::Options options;
-  options.function_tolerance = 1e-12;
-  options.max_num_iterations = 2000;
-  options.num_threads        = 1;
+  if (!restart) {
+    auto t2       = high_resolution_clock::now();
+    auto duration = duration_cast<seconds>( t2 - t1 );
+    std::cout << "Steady solution computed in " << duration.count() << "s\n";
+  }
 
-  ceres::Solve(options, &problem_steady, &summary);
-  auto t2       = high_resolution_clock::now();
-  auto duration = duration_cast<seconds>( t2 - t1 );
-  std::cout << "Steady solution computed in " << duration.count() << "s\n";
+  if (args["memory"].as<bool>())
+    std::cout << "Memory footprint\n" << simulator.footprint().summary() << "\n";
 
   // ------------------------------------------------------------------------
   // Transient Solve
-  const double t_start = config["discretization"]["time"]["start"].get<double>();
-  const double t_end   = config["discretization"]["time"]["end"].get<double>();
-  const double dt      = config["discretization"]["time"]["step"].get<double>();
-  const int    Nt      = std::ceil((t_end - t_start)*3600/dt);
-  float        time;
+  const double t_start   = config["discretization"]["time"]["start"].get<double>();
+  const double t_end     = config["discretization"]["time"]["end"].get<double>();
+  const double dt        = config["discretization"]["time"]["step"].get<double>();
+  const int    Nt        = std::ceil((t_end - t_start)*3600/dt);
+  const int    t_restart = simulator.step_count();
 
-  Vector current_state = init_state;
-  Vector guess         = init_state;
+  simulator.boundary_update = [&](double time, double dt, Eigen::Vector4d& u_b, Vector& guess) {
+    // Update guess at inlet and outlet
+    guess(0)                = fluid.density(inlet_pressure, inlet_temperature);
+    guess(guess.size()-1)   = momentum_at_outlet(time);
+
+    // Update input vector
+    u_b(3) = -(momentum_at_outlet(time) + momentum_at_outlet(time-dt)) * 0.5;
+  };
 
   // Read config for io frequency and filename
   int io_frequency     = config["io"]["frequency"].get<int>();
   std::string filename = config["io"]["filename"].get<std::string>();
 
-  phgasnets::NetworkStateWriter network_writer(filename+".h5", network);
-  network_writer.writeMesh();
-  network_writer.writeState(0, 0);
-
-  // CSV write out: Initialize vectors
-  std::vector<double> timestamps(Nt);
-  std::vector<std::vector<double>> inflow_pressure;
-  std::vector<std::vector<double>> outflow_pressure;
-  std::vector<std::vector<double>> inflow_momentum;
-  std::vector<std::vector<double>> outflow_momentum;
-
-  std::size_t i = 0;
-  for(auto& pipe: network.pipes){
-    double RT  = phgasnets::GAS_CONSTANT*pipe.temperature;
-
-    timestamps[0] = 0.0;
-    inflow_pressure.push_back(std::vector<double>(Nt));
-    outflow_pressure.push_back(std::vector<double>(Nt));
-    inflow_momentum.push_back(std::vector<double>(Nt));
-    outflow_momentum.push_back(std::vector<double>(Nt));
-
-    inflow_pressure[i][0] = pipe.rho(0)*RT/1e5;
-    outflow_pressure[i][0] = pipe.rho(Eigen::last)*RT/1e5;
-    inflow_momentum[i][0] = pipe.mom(0);
-    outflow_momentum[i][0] = pipe.mom(Eigen::last);
-
-    ++i;
+  // Layout, compression and precision of the results file (optional)
+  const auto output_options = phgasnets::outputOptionsFromJson(config["io"]);
+
+  // States are written on a background thread, while the solver continues
+  phgasnets::AsyncNetworkStateWriter network_writer(filename+".h5", network, restart, output_options);
+  if (restart) {
+    network_writer.discardAfter(simulator.time());
+  }
+  else {
+    network_writer.writeMesh();
+    network_writer.writeState(0, simulator.time(), simulator.state());
   }
 
-  t1 = high_resolution_clock::now();
+  // Read config for checkpoint frequency and filename (optional)
+  const bool checkpointing = config["io"].contains("checkpoint");
+  int checkpoint_frequency = 0;
+  std::string checkpoint_filename;
+  if (checkpointing) {
+    checkpoint_frequency = config["io"]["checkpoint"]["frequency"].get<int>();
+    checkpoint_filename  = config["io"]["checkpoint"]["filename"].get<std::string>();
+  }
 
-  Problem problem_transient;
-  auto cost_function_transient =
-    new DynamicDiffCostFunction<phgasnets::TransientCompressorSystem>(
-      new phgasnets::TransientCompressorSystem(net, config["discretization"], current_state, u_b, time)
-  );
+  // CSV write out (optional): inlet and outlet of every pipe, streamed at the io frequency
+  std::vector<std::unique_ptr<phgasnets::CSVWriter>> boundary_csv;
+  if (args.count("csv")) {
+    for (std::size_t p = 0; p < network.pipes.size(); ++p) {
+      boundary_csv.push_back(std::make_unique<phgasnets::CSVWriter>(
+        filename+"_pipe"+std::to_string(p)+".csv",
+        std::vector<std::string>{"time", "inletPressure", "outletPressure", "inletMomentum", "outletMomentum"}
+      ));
+    }
+  }
+  // Time [h], pressure [bar] and momentum at both ends of every pipe
+  auto write_boundaries = [&](const int t, const double time, const Vector& state) {
+    if (boundary_csv.empty() || t % io_frequency != 0)
+      return;
+    int pipe_state_startIdx = 0;
+    for (std::size_t p = 0; p < network.pipes.size(); ++p) {
+      const auto& pipe = network.pipes[p];
+      const double* rho = state.data() + pipe_state_startIdx;
+      const double* mom = rho + pipe.n_rho;
+      boundary_csv[p]->writeRow({
+        time/3600.0,
+        pipe.pressure(rho[0])/1e5,
+        pipe.pressure(rho[pipe.n_rho-1])/1e5,
+        mom[0],
+        mom[pipe.n_mom-1]
+      });
+      pipe_state_startIdx += pipe.n_state;
+    }
+  };
+  write_boundaries(t_restart, simulator.time(), simulator.state());
+
+  // Sensor locations (optional), e.g. "probes": {"frequency": 1, "locations": [{"name": "mid", "pipe": 0, "position": 90750}]}
+  std::unique_ptr<phgasnets::ProbeRecorder> probe_recorder;
+  if (config["io"].contains("probes")) {
+    probe_recorder = std::make_unique<phgasnets::ProbeRecorder>(
+      network,
+      phgasnets::probesFromJson(config["io"]["probes"]["locations"]),
+      config["io"]["probes"].value("frequency", 1)
+    );
+    probe_recorder->streamCSV(filename+"_probes.csv");
+    probe_recorder->record(t_restart, simulator.time(), simulator.state());
+  }
 
-  cost_function_transient->AddParameterBlock(network.n_state);
-  cost_function_transient->SetNumResiduals(network.n_res);
-  problem_transient.AddResidualBlock(cost_function_transient, nullptr, guess.data());
+  // Pressure range and linepack statistics (optional)
+  std::unique_ptr<phgasnets::NetworkStatistics> statistics;
+  if (config["io"].value("statistics", false)) {
+    statistics = std::make_unique<phgasnets::NetworkStatistics>(network);
+    statistics->record(simulator.state());
+  }
 
-  // Time Loop
-  for (int t=1; t<Nt; ++t) {
+  // Reference results to compare against (optional), read before the time loop
+  // such that the loop does not wait on the results writer for HDF5 access
+  const bool comparing = args.count("compare");
+  std::vector<double> reference_times;
+  std::vector<Vector> reference_states;
+  double max_deviation = 0.0;
+  int n_compared = 0;
+  if (comparing) {
+    const phgasnets::NetworkStateReader reference(args["compare"].as<std::string>(), network);
+    for (std::size_t n = 0; n < reference.size(); ++n) {
+      if (reference.times()[n] > simulator.time()) {
+        reference_times.push_back(reference.times()[n]);
+        reference_states.push_back(reference.state(n));
+      }
+    }
+  }
 
-    time = t_start*3600 + t * dt;
-    std::cout << "Time = " << time << "s (" << t << "/" << Nt << ")\r";
+  // Per-step solver telemetry as JSON lines (optional)
+  std::unique_ptr<phgasnets::SolverTelemetry> telemetry;
+  if (config["io"].value("telemetry", false)) {
+    telemetry = std::make_unique<phgasnets::SolverTelemetry>(filename+"_telemetry.jsonl", restart);
+    // Steps after the checkpoint are computed again
+    if (restart)
+      telemetry->discardAfter(t_restart);
+  }
 
-    // Update guess at inlet
-    guess(0)                 = inlet_pressure/(phgasnets::GAS_CONSTANT*inlet_temperature);
-    guess(network.n_state-1) = momentum_at_outlet(time);
+  // Live state feed for monitoring (optional)
+  std::unique_ptr<phgasnets::SharedStateFeed> feed;
+  if (args.count("feed")) {
+    feed = std::make_unique<phgasnets::SharedStateFeed>(args["feed"].as<std::string>(), network);
+    feed->publish(t_restart, simulator.time(), simulator.state());
+  }
 
-    // Update input vector
-    u_b(3) = -(momentum_at_outlet(time) + momentum_at_outlet(time-dt)) * 0.5;
+  t1 = high_resolution_clock::now();
 
-    ceres::Solve(options, &problem_transient, &summary);
+  // Time Loop
+  for (int t=t_restart+1; t<Nt; ++t) {
 
-    current_state = guess; // Set the current state to the new solution
-    network.set_state(current_state);
+    const auto& summary = simulator.step(dt);
+    const double time = simulator.time();
+    std::cout << "Time = " << time << "s (" << t << "/" << Nt << ")\r";
 
     // IO
+    auto io_start = high_resolution_clock::now();
     if (t % io_frequency == 0) {
-        network_writer.writeState(t, time);
-
-        std::size_t i = 0;
-        for(auto& pipe: network.pipes){
-          double RT  = phgasnets::GAS_CONSTANT*pipe.temperature;
-
-          timestamps[t] = time/3600.0;
+        network_writer.writeState(t, time, simulator.state());
+    }
+    write_boundaries(t, time, simulator.state());
+    if (probe_recorder) {
+      probe_recorder->record(t, time, simulator.state());
+    }
+    if (statistics) {
+      statistics->record(simulator.state());
+    }
+    if (feed) {
+      feed->publish(t, time, simulator.state());
+    }
+    if (!reference_times.empty() && t % io_frequency == 0 && time >= reference_times.front()) {
+      const auto n = (std::upper_bound(reference_times.begin(), reference_times.end(), time) - reference_times.begin()) - 1;
+      if (std::abs(reference_times[n] - time) < 1e-6*dt) {
+        const Vector& reference_state = reference_states[n];
+        max_deviation = std::max(
+          max_deviation,
+          ((simulator.state() - reference_state).cwiseAbs().array() / reference_state.cwiseAbs().array().max(1e-12)).maxCoeff()
+        );
+        ++n_compared;
+      }
+    }
 
-          inflow_pressure[i][t] = pipe.rho(0)*RT/1e5;
-          outflow_pressure[i][t] = pipe.rho(Eigen::last)*RT/1e5;
-          inflow_momentum[i][t] = pipe.mom(0);
-          outflow_momentum[i][t] = pipe.mom(Eigen::last);
+    if (checkpointing && t % checkpoint_frequency == 0) {
+      phgasnets::writeCheckpoint(checkpoint_filename, simulator.checkpoint());
+    }
 
-          ++i;
-        }
+    if (telemetry) {
+      const std::chrono::duration<double> io_wait_time = high_resolution_clock::now() - io_start;
+      telemetry->record(t, time, dt, summary, io_wait_time.count());
     }
   }
 
+  network_writer.flush();
   std::cout << "Results written in [" << filename << "]" << std::endl;
 
-  if (args.count("csv")) {
+  if (args.count("trace")) {
+    phgasnets::stopTracing(args["trace"].as<std::string>());
+    std::cout << "Trace written in [" << args["trace"].as<std::string>() << "]" << std::endl;
+  }
 
-    std::size_t i = 0;
-    for(auto& pipe: network.pipes){
-      phgasnets::writeColumnsToCSV(
-        filename+"_pipe"+std::to_string(i)+".csv",
-        {
-          "time",
-          "inletPressure",
-          "outletPressure",
-          "inletMomentum",
-          "outletMomentum"
-        },
-        {
-          timestamps,
-          inflow_pressure[i],
-          outflow_pressure[i],
-          inflow_momentum[i],
-          outflow_momentum[i]
-        }
-      );
+  if (comparing) {
+    std::cout << "Maximum relative deviation from [" << args["compare"].as<std::string>() << "]: "
+              << max_deviation << " over " << n_compared << " time steps" << std::endl;
+  }
+
+  // Only the steps computed in this run are written, a failed write throws
+  for (std::size_t i = 0; i < boundary_csv.size(); ++i) {
+    boundary_csv[i]->flush();
+    std::cout
+      << "CSV file written in ["
+      << filename+"_pipe"+std::to_string(i)+".csv"
+      << "]"
+      << std::endl;
+  }
 
-      std::cout
-        << "CSV file written in ["
-        << filename+"_pipe"+std::to_string(i)+".csv"
-        << "]"
-        << std::endl;
+  if (probe_recorder) {
+    std::cout << "Probes written in [" << filename << "_probes.csv]" << std::endl;
+  }
 
-      ++i;
+  if (statistics) {
+    json stats = statistics->to_json();
+    if (probe_recorder) {
+      stats["probes"] = probe_recorder->statistics();
     }
+    std::ofstream stats_file(filename+"_statistics.json");
+    stats_file << stats.dump(2) << std::endl;
+    std::cout << "Statistics written in [" << filename << "_statistics.json]" << std::endl;
+  }
 
+  if (telemetry) {
+    const json totals = telemetry->to_json(1);
+    std::cout << "Telemetry written in [" << filename << "_telemetry.jsonl]: "
+              << totals["iterations"]["mean"] << " iterations per step on average, "
+              << totals["solver_time"] << "s in the solver ("
+              << totals["jacobian_time"] << "s Jacobian, "
+              << totals["linear_solver_time"] << "s linear solves), "
+              << totals["io_wait_time"] << "s waiting on IO, "
+              << network_writer.write_time() << "s writing states in the background" << std::endl;
+    if (!totals["slowest_steps"].empty()) {
+      std::cout << "Most expensive step: " << totals["slowest_steps"][0].dump() << std::endl;
+    }
   }
 
-  t2       = high_resolution_clock::now();
-  duration = duration_cast<seconds>( t2 - t1 );
+  auto t2       = high_resolution_clock::now();
+  auto duration = duration_cast<seconds>( t2 - t1 );
   std::cout << "Transient solution computed in " << duration.count() << "s\t ("
-            << duration.count()/(float)Nt << "s per timestep).\n";
+            << duration.count()/(float)(Nt - t_restart) << "s per timestep).\n";
 
   return 0;
 
@@ -0,0 +1,89 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# include <iostream>
+# include <iomanip>
+# include <chrono>
+# include <thread>
+# include <cxxopts.hpp>
+# include <Eigen/Core>
+# include <phgasnets>
+
+int main(int argc, char** argv){
+
+  cxxopts::Options parser("live_monitor", "Watches the live state feed of a running simulation");
+  parser.add_options()
+    (
+      "f,feed",
+      "Name of the shared memory live state feed",
+      cxxopts::value<std::string>()
+        ->default_value("/phgasnets")
+    )
+    (
+      "i,interval",
+      "Polling interval in milliseconds",
+      cxxopts::value<int>()
+        ->default_value("500")
+    )
+    (
+      "t,timeout",
+      "Stop after this many seconds without a new state",
+      cxxopts::value<double>()
+        ->default_value("10")
+    )
+    ("h,help", "Print usage")
+    ;
+
+  cxxopts::ParseResult args;
+  try {
+    args = parser.parse(argc, argv);
+  }
+  catch (const cxxopts::exceptions::exception& err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << parser.help() << std::endl;
+    std::exit(1);
+  }
+
+  if (args.count("help")) {
+    std::cout << parser.help() << std::endl;
+    return 0;
+  }
+
+  const auto interval = std::chrono::milliseconds(args["interval"].as<int>());
+  const auto timeout  = std::chrono::duration<double>(args["timeout"].as<double>());
+
+  phgasnets::SharedStateFeedReader reader(args["feed"].as<std::string>());
+
+  std::int64_t step;
+  double time;
+  Eigen::VectorXd state, pressure;
+  std::uint64_t last_published = 0;
+  auto last_update = std::chrono::steady_clock::now();
+
+  std::cout << std::fixed << std::setprecision(2);
+  while (std::chrono::steady_clock::now() - last_update < timeout) {
+    const std::uint64_t published = reader.published();
+    if (published != last_published && reader.read(step, time, state, pressure)) {
+      last_published = published;
+      last_update = std::chrono::steady_clock::now();
+
+      // Inlet and outlet pressure [bar] of every pipe, as published by the simulation
+      std::cout << "t = " << time/3600.0 << "h (step " << step << ")";
+      int pipe_pressure_startIdx = 0;
+      for (std::size_t p = 0; p < reader.pipes.size(); ++p) {
+        const auto& pipe = reader.pipes[p];
+        std::cout << "  pipe" << p << ": "
+                  << pressure(pipe_pressure_startIdx)/1e5 << " -> "
+                  << pressure(pipe_pressure_startIdx+pipe.n_rho-1)/1e5 << " bar";
+        pipe_pressure_startIdx += pipe.n_rho;
+      }
+      std::cout << std::endl;
+    }
+    std::this_thread::sleep_for(interval);
+  }
+
+  return 0;
+}
@@ -0,0 +1,294 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# include <iostream>
+# include <fstream>
+# include <cxxopts.hpp>
+# include <Eigen/Dense>
+# include <chrono>
+# include <ceres/ceres.h>
+# include <nlohmann/json.hpp>
+# include <phgasnets>
+
+// Define the json library
+using json = nlohmann::json;
+
+// Shorthand Types
+typedef Eigen::VectorXd Vector;
+
+typedef ceres::Solver Solver;
+typedef ceres::Problem Problem;
+
+double momentum_at_outlet(double time) {
+  if (time < 6*3600) {
+      return 463.33;
+  } else if (time < 12*3600) {
+      return 540.55;
+  } else if (time < 18*3600) {
+      return 386.11;
+  } else {
+      return 463.33;
+  }
+}
+
+int main(int argc, char** argv){
+
+  using std::chrono::high_resolution_clock;
+  using std::chrono::duration_cast;
+  using std::chrono::milliseconds;
+
+  cxxopts::Options parser("reduced_order", "Demo for POD reduced-order model of the compressor testcase");
+  parser.add_options()
+    (
+      "c,config",
+      "Path to the <config-file>.json",
+      cxxopts::value<std::string>()
+        ->default_value("config.json")
+    )
+    (
+      "csv",
+      "Flag to output <csv-file>.csv",
+      cxxopts::value<bool>()
+        ->default_value("false")
+        ->implicit_value("true")
+    )
+    ("h,help", "Print usage")
+    ;
+
+  cxxopts::ParseResult args;
+  try {
+    args = parser.parse(argc, argv);
+  }
+  catch (const cxxopts::exceptions::exception& err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << parser.help() << std::endl;
+    std::exit(1);
+  }
+
+  if (args.count("help")) {
+    std::cout << parser.help() << std::endl;
+    return 0;
+  }
+
+  // Read the JSON file
+  std::ifstream config_file(args["config"].as<std::string>());
+  json config = json::parse(config_file);
+
+  const double inlet_temperature = config["boundary_conditions"]["inlet"]["temperature"].get<double>();
+  const double inlet_pressure    = config["boundary_conditions"]["inlet"]["pressure"].get<double>();
+  const double compr_spec        = config["compressor"]["specification"].get<double>();
+  const double kappa             = config["fluid"]["isentropic_exponent"].get<double>();
+  const int    Nx                = config["discretization"]["space"]["resolution"].get<int>();
+
+  // Gas transported by the network
+  const phgasnets::Fluid fluid(config["GAS_CONSTANT"].get<double>());
+
+  // Make Pipes and Compressor objects
+  std::vector<phgasnets::Compressor> compressors = {
+        phgasnets::Compressor(config["compressor"], kappa)
+  };
+
+  const double outlet_temperature = inlet_temperature * compressors[0].temperature_scale;
+
+  std::vector<phgasnets::Pipe> pipes = {
+    phgasnets::Pipe(config["pipe"], inlet_temperature),
+    phgasnets::Pipe(config["pipe"], outlet_temperature)
+  };
+
+  phgasnets::Network net = phgasnets::Network(pipes, compressors, fluid);
+
+  auto network = phgasnets::discretize<double>(net, config["discretization"]["space"]);
+
+  // ------------------------------------------------------------------------
+  // Steady State Solve
+  const double p0   = config["initial_conditions"]["pressure"].get<double>();
+  const double mom0 = config["initial_conditions"]["momentum"].get<double>();
+
+  Vector pipeL_init_density(Nx+1), pipeL_init_momentum(Nx+1);
+  pipeL_init_density.setConstant(p0/fluid.RT(inlet_temperature));
+  pipeL_init_momentum.setConstant(mom0/network.compressors[0].momentum_scale);
+
+  if (network.compressors[0].type == "FP") {
+    network.compressors[0].update_compression_ratio(compr_spec/p0);
+  }
+  else if (network.compressors[0].type == "FC") {
+    network.compressors[0].update_compression_ratio(compr_spec);
+  }
+
+  Vector pipeR_init_density(Nx+1), pipeR_init_momentum(Nx+1);
+  pipeR_init_density.setConstant(p0*network.compressors[0].compression_ratio/fluid.RT(outlet_temperature));
+  pipeR_init_momentum.setConstant(mom0);
+
+  Vector init_state = phgasnets::verticallyBlockVectors({
+    pipeL_init_density, pipeL_init_momentum,
+    pipeR_init_density, pipeR_init_momentum
+  });
+
+  Eigen::Vector4d u_b({
+    inlet_pressure,
+    0.0,
+    network.compressors[0].specification,
+    -momentum_at_outlet(0.0)
+  });
+
+  if (network.compressors[0].model == "AV") {
+    u_b(1) = 1.0/std::pow(network.compressors[0].specification, 1/network.compressors[0].isentropic_exponent);
+  }
+  else if (network.compressors[0].model == "AM") {
+    u_b(1) = 1.0;
+  }
+
+  // Jacobians by automatic or numeric differentiation, as configured
+  const auto differentiation = phgasnets::differentiationFromJson(config["discretization"]);
+
+  Problem problem_steady;
+  auto cost_function_steady = phgasnets::differentiate(
+      new phgasnets::SteadyCompressorSystem(net, config["discretization"]["space"], u_b),
+      differentiation
+  );
+
+  cost_function_steady->AddParameterBlock(network.n_state);
+  cost_function_steady->SetNumResiduals(network.n_res);
+
+  problem_steady.AddResidualBlock(cost_function_steady, nullptr, init_state.data());
+
+  Solver::Summary summary;
+  Solver::Options options;
+  options.function_tolerance = 1e-12;
+  options.max_num_iterations = 2000;
+  options.num_threads        = 1;
+
+  ceres::Solve(options, &problem_steady, &summary);
+  network.set_state(init_state);
+
+  const double t_start = config["discretization"]["time"]["start"].get<double>();
+  const double t_end   = config["discretization"]["time"]["end"].get<double>();
+  const double dt      = config["discretization"]["time"]["step"].get<double>();
+  const int    Nt      = std::ceil((t_end - t_start)*3600/dt);
+  const Eigen::Vector4d u_init = u_b;
+  float        time;
+
+  // ------------------------------------------------------------------------
+  // Offline: full-order transient solve collecting snapshots
+  auto t1 = high_resolution_clock::now();
+
+  Vector current_state = init_state;
+  Vector guess         = init_state;
+
+  phgasnets::Snapshots snapshots;
+  snapshots.add(current_state);
+
+  std::vector<double> timestamps(Nt), outflow_pressure_full(Nt), outflow_pressure_rom(Nt);
+  const double RT_out = network.pipes[1].RT;
+  timestamps[0] = t_start;
+  outflow_pressure_full[0] = network.pipes[1].rho(Eigen::last)*RT_out/1e5;
+
+  Problem problem_transient;
+  auto cost_function_transient =
+    phgasnets::differentiate(
+      new phgasnets::TransientCompressorSystem(net, config["discretization"], current_state, u_b, time),
+      differentiation
+  );
+
+  cost_function_transient->AddParameterBlock(network.n_state);
+  cost_function_transient->SetNumResiduals(network.n_res);
+  problem_transient.AddResidualBlock(cost_function_transient, nullptr, guess.data());
+
+  for (int t=1; t<Nt; ++t) {
+    time = t_start*3600 + t * dt;
+
+    guess(0)                 = inlet_pressure/fluid.RT(inlet_temperature);
+    guess(network.n_state-1) = momentum_at_outlet(time);
+    u_b(3) = -(momentum_at_outlet(time) + momentum_at_outlet(time-dt)) * 0.5;
+
+    ceres::Solve(options, &problem_transient, &summary);
+
+    current_state = guess;
+    network.set_state(current_state);
+    snapshots.add(current_state);
+
+    timestamps[t] = time/3600.0;
+    outflow_pressure_full[t] = network.pipes[1].rho(Eigen::last)*RT_out/1e5;
+  }
+
+  auto t2 = high_resolution_clock::now();
+  auto duration_full = duration_cast<milliseconds>( t2 - t1 );
+
+  // ------------------------------------------------------------------------
+  // Build the reduced-order model
+  auto rom = phgasnets::reduce(network, snapshots.matrix(), config["reduced_order"]);
+  std::cout << "Reduced model with " << rom.n_state << " unknowns (full model: "
+            << network.n_state << ")\n";
+
+  // ------------------------------------------------------------------------
+  // Online: reduced transient solve over the same scenario
+  t1 = high_resolution_clock::now();
+
+  Vector reduced_state = rom.project(init_state);
+  Vector reduced_guess = reduced_state;
+  u_b = u_init;
+
+  Problem problem_reduced;
+  auto cost_function_reduced =
+    phgasnets::differentiate(
+      new phgasnets::ReducedTransientCompressorSystem(rom, config["discretization"], reduced_state, u_b),
+      differentiation
+  );
+
+  cost_function_reduced->AddParameterBlock(rom.n_state);
+  cost_function_reduced->SetNumResiduals(rom.n_res);
+  problem_reduced.AddResidualBlock(cost_function_reduced, nullptr, reduced_guess.data());
+
+  const int n_rho_out = network.pipes[1].n_rho;
+  const int offset_out = network.pipes[0].n_state;
+  outflow_pressure_rom[0] = outflow_pressure_full[0];
+
+  double max_error = 0.0;
+  for (int t=1; t<Nt; ++t) {
+    time = t_start*3600 + t * dt;
+    u_b(3) = -(momentum_at_outlet(time) + momentum_at_outlet(time-dt)) * 0.5;
+
+    ceres::Solve(options, &problem_reduced, &summary);
+    reduced_state = reduced_guess;
+
+    Vector state = rom.lift(reduced_state);
+    outflow_pressure_rom[t] = state(offset_out+n_rho_out-1)*RT_out/1e5;
+    max_error = std::max(max_error, std::abs(outflow_pressure_rom[t] - outflow_pressure_full[t])/outflow_pressure_full[t]);
+  }
+
+  t2 = high_resolution_clock::now();
+  auto duration_rom = duration_cast<milliseconds>( t2 - t1 );
+
+  std::cout << "Full-order transient solution computed in " << duration_full.count() << "ms\n";
+  std::cout << "Reduced-order transient solution computed in " << duration_rom.count() << "ms\n";
+  std::cout << "Max. relative error in outlet pressure: " << max_error << "\n";
+
+  if (args.count("csv")) {
+    std::string filename = config["io"]["filename"].get<std::string>();
+    phgasnets::writeColumnsToCSV(
+      filename+".csv",
+      {
+        "time",
+        "outletPressureFOM",
+        "outletPressureROM"
+      },
+      {
+        timestamps,
+        outflow_pressure_full,
+        outflow_pressure_rom
+      }
+    );
+
+    std::cout
+      << "CSV file written in ["
+      << filename+".csv"
+      << "]"
+      << std::endl;
+  }
+
+  return 0;
+
+}
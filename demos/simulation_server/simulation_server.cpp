@@ -0,0 +1,149 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# include <iostream>
+# include <fstream>
+# include <chrono>
+# include <cxxopts.hpp>
+# include <Eigen/Dense>
+# include <nlohmann/json.hpp>
+# include <phgasnets>
+
+// Define the json library
+using json = nlohmann::json;
+
+// Shorthand Types
+typedef Eigen::VectorXd Vector;
+
+int main(int argc, char** argv){
+
+  using std::chrono::high_resolution_clock;
+  using std::chrono::duration_cast;
+  using std::chrono::milliseconds;
+
+  cxxopts::Options parser("simulation_server", "Resident simulator answering what-if scenarios over a Unix socket");
+  parser.add_options()
+    (
+      "c,config",
+      "Path to the <config-file>.json",
+      cxxopts::value<std::string>()
+        ->default_value("config.json")
+    )
+    (
+      "s,socket",
+      "Path to the Unix domain socket",
+      cxxopts::value<std::string>()
+        ->default_value("/tmp/phgasnets.sock")
+    )
+    ("h,help", "Print usage")
+    ;
+
+  cxxopts::ParseResult args;
+  try {
+    args = parser.parse(argc, argv);
+  }
+  catch (const cxxopts::exceptions::exception& err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << parser.help() << std::endl;
+    std::exit(1);
+  }
+
+  if (args.count("help")) {
+    std::cout << parser.help() << std::endl;
+    return 0;
+  }
+
+  // Read the JSON file
+  std::ifstream config_file(args["config"].as<std::string>());
+  json config = json::parse(config_file);
+
+  const double inlet_temperature = config["boundary_conditions"]["inlet"]["temperature"].get<double>();
+  const double inlet_pressure    = config["boundary_conditions"]["inlet"]["pressure"].get<double>();
+  const double compr_spec        = config["compressor"]["specification"].get<double>();
+  const double kappa             = config["fluid"]["isentropic_exponent"].get<double>();
+  const int    Nx                = config["discretization"]["space"]["resolution"].get<int>();
+
+  // Gas transported by the network
+  const phgasnets::Fluid fluid = phgasnets::fluidFromJson(config["fluid"], config["GAS_CONSTANT"].get<double>());
+
+  // Make Pipes and Compressor objects
+  std::vector<phgasnets::Compressor> compressors = {
+        phgasnets::Compressor(config["compressor"], kappa)
+  };
+
+  const double outlet_temperature = inlet_temperature * compressors[0].temperature_scale;
+
+  std::vector<phgasnets::Pipe> pipes = {
+    phgasnets::Pipe(config["pipe"], inlet_temperature),
+    phgasnets::Pipe(config["pipe"], outlet_temperature)
+  };
+
+  const double p0   = config["initial_conditions"]["pressure"].get<double>();
+  const double mom0 = config["initial_conditions"]["momentum"].get<double>();
+
+  const double momentum_scale = compressors[0].momentum_scale;
+  if (compressors[0].type == "FP") {
+    compressors[0].update_compression_ratio(compr_spec/p0);
+  }
+  else if (compressors[0].type == "FC") {
+    compressors[0].update_compression_ratio(compr_spec);
+  }
+
+  phgasnets::Network net = phgasnets::Network(pipes, compressors, fluid);
+
+  // The network is discretized and the solver set up once, for all requests
+  phgasnets::Simulator simulator(net, config["discretization"]);
+
+  // Steady state as the baseline of every scenario
+  Vector pipeL_init_density(Nx+1), pipeL_init_momentum(Nx+1);
+  pipeL_init_density.setConstant(fluid.density(p0, inlet_temperature));
+  pipeL_init_momentum.setConstant(mom0/momentum_scale);
+
+  Vector pipeR_init_density(Nx+1), pipeR_init_momentum(Nx+1);
+  pipeR_init_density.setConstant(fluid.density(p0*compressors[0].compression_ratio, outlet_temperature));
+  pipeR_init_momentum.setConstant(mom0);
+
+  Vector init_state = phgasnets::verticallyBlockVectors({
+    pipeL_init_density, pipeL_init_momentum,
+    pipeR_init_density, pipeR_init_momentum
+  });
+
+  Eigen::Vector4d& u_b = simulator.input();
+  u_b = Eigen::Vector4d({
+    inlet_pressure,
+    0.0,
+    compressors[0].specification,
+    -mom0
+  });
+
+  if (compressors[0].model == "AV") {
+    u_b(1) = 1.0/std::pow(compressors[0].specification, 1/compressors[0].isentropic_exponent);
+  }
+  else if (compressors[0].model == "AM") {
+    u_b(1) = 1.0;
+  }
+
+  simulator.initialize(init_state);
+  const phgasnets::Checkpoint baseline = simulator.checkpoint();
+
+  phgasnets::SimulationServer server(
+    args["socket"].as<std::string>(),
+    [&](const json& request) {
+      auto t1 = high_resolution_clock::now();
+      json result = phgasnets::runScenario(simulator, baseline, request);
+      auto t2 = high_resolution_clock::now();
+      result["elapsed_ms"] = duration_cast<milliseconds>(t2 - t1).count();
+      std::cout << "Scenario over " << request["horizon"] << "s answered in " << result["elapsed_ms"] << "ms" << std::endl;
+      return result;
+    }
+  );
+
+  std::cout << "Serving scenarios on [" << server.socket_path << "]" << std::endl;
+  server.run();
+
+  return 0;
+
+}
@@ -26,17 +26,6 @@ typedef ceres::Solver Solver;
 typedef ceres::Problem Problem;
 typedef ceres::CostFunction CostFunction;
 
-// Switch between numeric and auto differentiation
-#if PHGASNETS_NUMERICDIFF
-#pragma message("Using NumericDiff")
-template<typename T>
-  using DynamicDiffCostFunction = ceres::DynamicNumericDiffCostFunction<T>;
-#else
-#pragma message("Using AutoDiff")
-  template<typename T>
-    using DynamicDiffCostFunction = ceres::DynamicAutoDiffCostFunction<T>;
-#endif
-
 double momentum_at_outlet(double time) {
   if (time < 6*3600) {
       return 463.33;
@@ -87,9 +76,9 @@ int main(int argc, char** argv) {
   std::ifstream config_file(args["config"].as<std::string>());
   json config = json::parse(config_file);
 
-  const double R              = config["GAS_CONSTANT"].get<double>();
+  const phgasnets::Fluid fluid(config["GAS_CONSTANT"].get<double>());
   const double temperature    = config["fluid"]["temperature"].get<double>();
-  const double RT             = R * temperature;
+  const double RT             = fluid.RT(temperature);
   const double pipe_length    = config["pipe"]["length"].get<double>();
   const double pipe_diameter  = config["pipe"]["diameter"].get<double>();
   const double pipe_friction  = config["pipe"]["friction"].get<double>();
@@ -105,7 +94,6 @@ int main(int argc, char** argv) {
   const int n_mom = Nx+1;
 
   // Create Port Hamiltonian Operators
-  phgasnets::set_gas_constant(R);
   auto Et     = phgasnets::Et_operator(n_rho, n_mom);
   auto Jt     = phgasnets::Jt_operator(n_rho, n_mom, mesh_width);
   auto G      = phgasnets::G_operator<double>(n_rho, n_mom);
@@ -129,12 +117,16 @@ int main(int argc, char** argv) {
   init_state.segment(0, n_rho).setConstant(rho0);
   init_state.segment(n_rho, n_mom).setConstant(mom0);
 
+  // Jacobians by automatic or numeric differentiation, as configured
+  const auto differentiation = phgasnets::differentiationFromJson(config["discretization"]);
+
   // SteadyState
   Problem problem_steady;
-  auto cost_function_steady = new DynamicDiffCostFunction<phgasnets::SteadySystem>(
+  auto cost_function_steady = phgasnets::differentiate(
       new phgasnets::SteadySystem(
-        n_rho, n_mom, Jt, G, pipe_friction, pipe_diameter, temperature, u_b
-      )
+        n_rho, n_mom, Jt, G, pipe_friction, pipe_diameter, temperature, fluid, u_b
+      ),
+      differentiation
   );
 
   cost_function_steady->AddParameterBlock(n_rho+n_mom);
@@ -188,10 +180,11 @@ int main(int argc, char** argv) {
 
   Problem problem_transient;
   auto cost_function_transient =
-      new DynamicDiffCostFunction<phgasnets::TransientSystem>(
+      phgasnets::differentiate(
           new phgasnets::TransientSystem(
-            n_rho, n_mom, current_state, Et, Jt, G, pipe_friction, pipe_diameter, temperature, u_b, time, dt
-          )
+            n_rho, n_mom, current_state, Et, Jt, G, pipe_friction, pipe_diameter, temperature, fluid, u_b, time, dt
+          ),
+          differentiation
   );
 
   cost_function_transient->AddParameterBlock(n_rho+n_mom);
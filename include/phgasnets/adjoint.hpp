@@ -0,0 +1,114 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# pragma once
+
+# include "network.hpp"
+# include "transient.hpp"
+
+# include <memory>
+# include <vector>
+# include <Eigen/Core>
+# include <Eigen/SparseCore>
+# include <nlohmann/json.hpp>
+# include <ceres/ceres.h>
+
+namespace phgasnets {
+
+  struct AdjointGradient {
+      std::vector<Eigen::VectorXd> inputs; // dJ/du for every recorded time step
+      Eigen::VectorXd friction;            // dJ/df for every pipe
+      Eigen::VectorXd initial_state;       // dJ/dz_0
+  };
+
+  /**
+   * Discrete adjoint of the implicit midpoint time loop of TransientCompressorSystem.
+   *
+   * Each time step solves F(z_{n+1}, z_n, u_n, f) = 0 in the least-squares sense, such that
+   * dz_{n+1} = -A^+ (B dz_n + C du_n + D df) with A = dF/dz_{n+1}, B = A - 2E/dt, C = -G and
+   * D = R e / f. The backward sweep evaluates A with the same cost function as the forward
+   * solve, i.e., one Jacobian evaluation and one sparse QR factorization per step.
+   *
+   * The network may be any chain of pipes joined by compressors, with the input layout of
+   * DiscreteNetwork: the inlet pressure, coupling factor and specification of every compressor,
+   * and the outlet momentum, i.e., two entries per pipe.
+   */
+  struct TransientAdjoint {
+      /**
+       * @param network the network of pipes and compressors
+       * @param disc_params the discretization parameters of the forward run
+       *
+       * @throws std::invalid_argument if the network is not a chain of pipes joined by compressors
+       */
+      TransientAdjoint(
+          const Network& network,
+          const nlohmann::json& disc_params
+      );
+
+      /**
+       * Records the initial state of the trajectory, discarding previous records.
+       *
+       * @param state the initial network state
+       */
+      void record_initial_state(const Eigen::Ref<const Eigen::VectorXd>& state);
+
+      /**
+       * Records a time step of the forward run.
+       *
+       * @param input_vec the input used in the step
+       * @param state the network state at the end of the step
+       *
+       * @throws std::invalid_argument if the input or the state does not match the network
+       */
+      void record(
+          const Eigen::Ref<const Eigen::VectorXd>& input_vec,
+          const Eigen::Ref<const Eigen::VectorXd>& state
+      );
+
+      /**
+       * Computes gradients of J = sum_n w_n^T z_n by a backward sweep over the recorded trajectory.
+       *
+       * @param output_sensitivities the weights w_n = dJ/dz_n for every recorded state (n = 0..N)
+       *
+       * @return the gradient with respect to inputs, friction factors and initial state
+       *
+       * @throws std::invalid_argument if the sensitivities do not match the recorded states
+       */
+      AdjointGradient gradient(const std::vector<Eigen::VectorXd>& output_sensitivities);
+
+      public:
+        std::vector<Eigen::VectorXd> states;
+        std::vector<Eigen::VectorXd> inputs;
+
+      private:
+        DiscreteNetwork<double> network;
+        const double timestep;
+        // The residual binds time and time step by reference, both live as long as it does
+        const double time = 0.0;
+        Eigen::VectorXd current_state;
+        Eigen::VectorXd input_vec;
+        std::unique_ptr<ceres::CostFunction> cost_function;
+  };
+
+  /**
+   * Sensitivity of the pressure at a node of a pipe with respect to the network state.
+   * For a real gas, the pressure is linearized at the current state of the network.
+   *
+   * @param network the discretized network
+   * @param pipe_index index of the pipe
+   * @param node index of the node within the pipe
+   *
+   * @return vector w such that the pressure (perturbation) is w^T z
+   *
+   * @throws None
+   */
+  Eigen::VectorXd pressure_sensitivity(
+      const DiscreteNetwork<double>& network,
+      const int pipe_index,
+      const int node
+  );
+
+}
@@ -0,0 +1,82 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# pragma once
+
+# include "network.hpp"
+
+# include <string>
+# include <Eigen/Core>
+# include <nlohmann/json.hpp>
+
+namespace phgasnets {
+
+  /**
+   * Computes a stable hash of the network description and its discretization.
+   *
+   * @param network the network of pipes and compressors
+   * @param spatial_disc_params the spatial discretization parameters
+   *
+   * @return hexadecimal FNV-1a hash, identical across runs and platforms
+   *
+   * @throws None
+   */
+  std::string network_hash(
+      const Network& network,
+      const nlohmann::json& spatial_disc_params
+  );
+
+  /**
+   * On-disk cache of converged steady states of one network, keyed by operating point.
+   *
+   * All states of a network live in a single HDF5 file named after the network hash
+   * within the cache directory. Operating points (e.g. the boundary input vector) are
+   * compared by their relative distance, so that nearby points yield warm starts.
+   */
+  struct SteadyStateCache {
+      SteadyStateCache(
+          const std::string& directory,
+          const Network& network,
+          const nlohmann::json& spatial_disc_params
+      );
+
+      /**
+       * Looks up the cached state with the nearest operating point.
+       *
+       * @param operating_point the operating point to look up
+       * @param state overwritten with the nearest cached state, if any
+       * @param distance overwritten with the relative distance to the nearest operating point
+       *
+       * @return true if the cache holds a state for this network
+       */
+      bool lookup(
+          const Eigen::Ref<const Eigen::VectorXd>& operating_point,
+          Eigen::VectorXd& state,
+          double& distance
+      ) const;
+
+      /**
+       * Adds a converged state to the cache and replaces the cache file.
+       *
+       * @param operating_point the operating point of the state
+       * @param state the converged steady state
+       *
+       * @throws std::runtime_error if the written file cannot replace the cache file
+       */
+      void store(
+          const Eigen::Ref<const Eigen::VectorXd>& operating_point,
+          const Eigen::Ref<const Eigen::VectorXd>& state
+      );
+
+      public:
+        const std::string filename;
+
+      private:
+        Eigen::MatrixXd operating_points; // one operating point per row
+        Eigen::MatrixXd states;           // one state per row
+  };
+
+}
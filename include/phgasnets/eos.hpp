@@ -0,0 +1,151 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# pragma once
+
+# include <algorithm>
+# include <array>
+# include <cmath>
+# include <memory>
+# include <vector>
+# include <ceres/jet.h>
+# include <nlohmann/json.hpp>
+
+namespace phgasnets {
+
+  /**
+   * A real-gas equation of state p = Z(p, T) rho R T, given by its compressibility factor.
+   */
+  struct EquationOfState {
+      virtual ~EquationOfState() = default;
+
+      // Compressibility factor Z at pressure [Pa] and temperature [K]
+      virtual double compressibility(const double pressure, const double temperature) const = 0;
+
+      // Derivative of the compressibility factor with respect to pressure [1/Pa]
+      virtual double compressibility_derivative(const double pressure, const double temperature) const = 0;
+
+      // Model and parameters, e.g. for cache keys
+      virtual nlohmann::json to_json() const = 0;
+
+      // Density [kg/m^3] at pressure and temperature, explicit in the compressibility factor
+      double density(const double pressure, const double temperature, const double gas_constant) const;
+
+      /**
+       * Pressure at density and temperature, solving p = Z(p, T) rho R T by Newton's method.
+       *
+       * @throws std::runtime_error if the iteration does not converge
+       */
+      double pressure(const double density, const double temperature, const double gas_constant) const;
+  };
+
+  /**
+   * The ideal gas, Z = 1, e.g. to check the tabulation against the exact ideal gas.
+   */
+  struct IdealGas : EquationOfState {
+      double compressibility(const double pressure, const double temperature) const override;
+      double compressibility_derivative(const double pressure, const double temperature) const override;
+      nlohmann::json to_json() const override;
+  };
+
+  /**
+   * Papay's correlation Z = 1 - 3.52 p_r exp(-2.26 T_r) + 0.274 p_r^2 exp(-1.878 T_r),
+   * in the reduced pressure p_r = p/p_c and temperature T_r = T/T_c.
+   */
+  struct PapayGas : EquationOfState {
+      /**
+       * @param critical_pressure pseudo-critical pressure [Pa], of methane by default
+       * @param critical_temperature pseudo-critical temperature [K], of methane by default
+       */
+      PapayGas(const double critical_pressure = 4.6e6, const double critical_temperature = 190.6);
+
+      double compressibility(const double pressure, const double temperature) const override;
+      double compressibility_derivative(const double pressure, const double temperature) const override;
+      nlohmann::json to_json() const override;
+
+      public:
+        const double critical_pressure, critical_temperature;
+  };
+
+  /**
+   * Reads an equation of state from {"model": "ideal"} or
+   * {"model": "papay", "critical_pressure": ..., "critical_temperature": ...}.
+   *
+   * @throws std::invalid_argument for an unknown model
+   */
+  std::shared_ptr<const EquationOfState> equationOfStateFromJson(const nlohmann::json& params);
+
+  /**
+   * Density range and resolution of pressure tables, given by the pressures they cover.
+   */
+  struct TableRange {
+      double min_pressure = 1e5;   // [Pa]
+      double max_pressure = 2e7;   // [Pa]
+      int nodes = 1024;
+  };
+
+  // Value of a double or of the scalar part of a Jet
+  inline double scalarPart(const double x) { return x; }
+
+  template<typename T, int N>
+  double scalarPart(const ceres::Jet<T, N>& x) { return scalarPart(x.a); }
+
+  /**
+   * Pressure as a function of density at a fixed temperature, tabulated on a uniform density grid
+   * and interpolated by cubic Hermite polynomials through the exact pressure and its derivative.
+   *
+   * The interpolant is continuously differentiable and evaluated with the scalar type of the
+   * density, such that Jets carry the derivative of the interpolant itself. Each interval stores
+   * its four polynomial coefficients contiguously, so a lookup reads 32 bytes. Beyond the table,
+   * the pressure is extrapolated linearly.
+   */
+  struct PressureTable {
+      /**
+       * @param eos the equation of state, kept for density lookups
+       * @param gas_constant specific gas constant [J/(kg K)]
+       * @param temperature the temperature [K]
+       * @param range pressure range and number of nodes of the table
+       */
+      PressureTable(
+          std::shared_ptr<const EquationOfState> eos,
+          const double gas_constant,
+          const double temperature,
+          const TableRange& range = TableRange()
+      );
+
+      template<typename T>
+      T pressure(const T& density) const {
+        const double s = (scalarPart(density) - min_density)*inverse_spacing;
+        if (s <= 0.0)
+          return coefficients.front()[0] + (density - min_density)*(coefficients.front()[1]*inverse_spacing);
+        if (s >= n_intervals)
+          return end_pressure + (density - max_density)*end_derivative;
+
+        const int k = std::min(static_cast<int>(s), n_intervals-1);
+        const auto& c = coefficients[k];
+        const T t = (density - min_density)*inverse_spacing - double(k);
+        return c[0] + t*(c[1] + t*(c[2] + t*c[3]));
+      }
+
+      // Derivative of the interpolated pressure with respect to density
+      double pressure_derivative(const double density) const;
+
+      // Density at pressure, from the equation of state
+      double density(const double pressure) const;
+
+      // Heap bytes of the table
+      std::size_t bytes() const;
+
+      private:
+        std::shared_ptr<const EquationOfState> eos;
+        const double gas_constant, temperature;
+        double min_density, max_density, inverse_spacing;
+        double end_pressure, end_derivative;
+        int n_intervals;
+        std::vector<std::array<double, 4>> coefficients;
+  };
+
+}
@@ -0,0 +1,148 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# pragma once
+
+# include "network.hpp"
+
+# include <atomic>
+# include <cstdint>
+# include <string>
+# include <vector>
+# include <Eigen/Core>
+
+namespace phgasnets {
+
+  /**
+   * Memory layout of a live state feed in POSIX shared memory.
+   *
+   *   FeedHeader | FeedPipe[n_pipes] | n_slots x (FeedSlot | double[n_state] | double[n_pressure])
+   *
+   * Each slot holds the network state followed by the pressure at every density node, pipe by pipe,
+   * evaluated with the equation of state of the simulation. Slots form a ring buffer. Each slot is guarded by a sequence lock: the writer makes
+   * the sequence odd while writing and even once done, such that readers detect and retry
+   * torn reads without ever blocking the writer.
+   */
+  struct FeedHeader {
+      std::uint64_t magic;
+      std::uint32_t version;
+      std::uint32_t n_pipes;
+      std::uint32_t n_slots;
+      std::uint32_t n_state;
+      std::uint32_t n_pressure;             // sum of n_rho over all pipes
+      std::atomic<std::uint64_t> published; // number of published states
+  };
+
+  struct FeedPipe {
+      std::int32_t n_rho, n_mom;
+      double length;
+  };
+
+  struct FeedSlot {
+      std::atomic<std::uint64_t> sequence;
+      double time;
+      std::int64_t step;
+  };
+
+  static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+                "The live state feed needs lock-free 64-bit atomics in shared memory.");
+
+  /**
+   * Publishes the latest network states into a POSIX shared memory ring buffer,
+   * e.g. for dashboards watching a running simulation.
+   *
+   * Publishing never waits on readers. The shared memory object is removed on destruction.
+   */
+  struct SharedStateFeed {
+      /**
+       * Creates the shared memory object, replacing any stale feed of the same name.
+       *
+       * @param name the shared memory object name, e.g. "/phgasnets"
+       * @param network the discretized network whose states are published, outliving the feed
+       * @param n_slots number of states kept in the ring buffer
+       *
+       * @throws std::runtime_error if the shared memory cannot be created or mapped
+       */
+      SharedStateFeed(
+          const std::string& name,
+          const DiscreteNetwork<double>& network,
+          const std::uint32_t n_slots = 8
+      );
+      ~SharedStateFeed();
+
+      SharedStateFeed(const SharedStateFeed&) = delete;
+      SharedStateFeed& operator=(const SharedStateFeed&) = delete;
+
+      /**
+       * Publishes a network state and its pressures.
+       *
+       * @param step the time step index
+       * @param time the simulation time [s]
+       * @param state full network state, laid out as in DiscreteNetwork::set_state
+       */
+      void publish(const std::int64_t step, const double time, const Eigen::Ref<const Eigen::VectorXd>& state);
+
+      public:
+        const std::string name;
+
+      private:
+        const DiscreteNetwork<double>& network;
+        std::size_t size;
+        void* memory;
+        FeedHeader* header;
+  };
+
+  /**
+   * Reads the latest state of a SharedStateFeed from another process.
+   */
+  struct SharedStateFeedReader {
+      /**
+       * Maps an existing feed read-only.
+       *
+       * @param name the shared memory object name
+       *
+       * @throws std::runtime_error if the feed does not exist, has an unknown format, or is smaller
+       *         than its header describes
+       */
+      SharedStateFeedReader(const std::string& name);
+      ~SharedStateFeedReader();
+
+      SharedStateFeedReader(const SharedStateFeedReader&) = delete;
+      SharedStateFeedReader& operator=(const SharedStateFeedReader&) = delete;
+
+      /**
+       * Copies the latest published state.
+       *
+       * @param step overwritten with the time step index
+       * @param time overwritten with the simulation time [s]
+       * @param state resized and overwritten with the network state
+       *
+       * @return false if no state has been published yet
+       */
+      bool read(std::int64_t& step, double& time, Eigen::VectorXd& state) const;
+
+      /**
+       * Copies the latest published state and its pressures.
+       *
+       * @param pressure resized and overwritten with the pressure at every density node, pipe by pipe [Pa]
+       *
+       * @return false if no state has been published yet
+       */
+      bool read(std::int64_t& step, double& time, Eigen::VectorXd& state, Eigen::VectorXd& pressure) const;
+
+      // Number of published states, to poll for updates
+      std::uint64_t published() const;
+
+      public:
+        std::vector<FeedPipe> pipes;
+
+      private:
+        std::size_t size;
+        void* memory;
+        const FeedHeader* header;
+  };
+
+}
@@ -0,0 +1,67 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# pragma once
+
+# include "gasconstant.hpp"
+# include "eos.hpp"
+
+# include <memory>
+# include <nlohmann/json.hpp>
+
+namespace phgasnets {
+
+  /**
+   * Properties of the gas transported by a network.
+   *
+   * Every network owns its fluid, such that networks of different gases may be simulated
+   * concurrently. Discretized pipes fold it into their pressure factor RT once, or, for a
+   * real gas, into a pressure table at their temperature.
+   */
+  struct Fluid {
+      /**
+       * @param gas_constant specific gas constant [J/(kg K)], the global default by default
+       * @param eos real-gas equation of state, the ideal gas without tables if empty
+       * @param table range and resolution of the pressure tables of a real gas
+       */
+      Fluid(
+          const double gas_constant = get_gas_constant(),
+          std::shared_ptr<const EquationOfState> eos = nullptr,
+          const TableRange& table = TableRange()
+      ) :
+        gas_constant(gas_constant), eos(eos), table(table)
+      {}
+
+      // Pressure factor p/rho of the ideal gas at the given temperature [K]
+      double RT(const double temperature) const { return gas_constant*temperature; }
+
+      // Whether the pressure is linear in density, p = rho*RT
+      bool ideal() const { return !eos; }
+
+      // Density [kg/m^3] at pressure [Pa] and temperature [K]
+      double density(const double pressure, const double temperature) const {
+        return ideal() ? pressure/RT(temperature) : eos->density(pressure, temperature, gas_constant);
+      }
+
+      public:
+        double gas_constant;
+        std::shared_ptr<const EquationOfState> eos;
+        TableRange table;
+  };
+
+  /**
+   * Reads the fluid of a configuration, e.g.
+   * {"equation_of_state": {"model": "papay"}, "pressure_table": {"min_pressure": 1e5, "max_pressure": 2e7, "nodes": 1024}}.
+   * Without an equation of state, the fluid is the ideal gas.
+   *
+   * @param params the fluid parameters, further keys are ignored
+   * @param gas_constant specific gas constant [J/(kg K)]
+   *
+   * @throws std::invalid_argument for an unknown equation of state
+   */
+  Fluid fluidFromJson(const nlohmann::json& params, const double gas_constant);
+
+}
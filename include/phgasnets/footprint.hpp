@@ -0,0 +1,70 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# pragma once
+
+# include <cstddef>
+# include <string>
+# include <vector>
+# include <Eigen/Core>
+# include <Eigen/SparseCore>
+
+namespace phgasnets {
+
+  /**
+   * Heap memory held by a discretization, as named entries in bytes.
+   *
+   * Names are hierarchical and dot-separated, e.g. "pipes.Jt.J.triplets",
+   * entries of the same name accumulate.
+   */
+  struct MemoryFootprint {
+      struct Entry {
+        std::string name;
+        std::size_t bytes;
+      };
+
+      // Adds bytes to the named entry
+      void add(const std::string& name, const std::size_t bytes);
+
+      // Adds all entries of another footprint, with their names prefixed
+      void add(const std::string& prefix, const MemoryFootprint& other);
+
+      // Total bytes of all entries whose name ends with the given suffix, e.g. ".triplets"
+      std::size_t total(const std::string& suffix = "") const;
+
+      /**
+       * A table of the entries aggregated over the first depth name components,
+       * with their share of the total, followed by the total and the bytes held in triplet lists.
+       */
+      std::string summary(const int depth = 2) const;
+
+      public:
+        std::vector<Entry> entries;
+  };
+
+  // Heap bytes of a dense Eigen vector or matrix
+  template<typename Derived>
+  std::size_t allocatedBytes(const Eigen::PlainObjectBase<Derived>& dense) {
+    return dense.size()*sizeof(typename Derived::Scalar);
+  }
+
+  // Heap bytes of a sparse matrix, including reserved but unused storage
+  template<typename T, int Options, typename StorageIndex>
+  std::size_t allocatedBytes(const Eigen::SparseMatrix<T, Options, StorageIndex>& sparse) {
+    std::size_t bytes = (sparse.outerSize()+1)*sizeof(StorageIndex)
+      + sparse.data().allocatedSize()*(sizeof(T)+sizeof(StorageIndex));
+    if (!sparse.isCompressed())
+      bytes += sparse.outerSize()*sizeof(StorageIndex);
+    return bytes;
+  }
+
+  // Heap bytes of a vector, including its spare capacity
+  template<typename T, typename Allocator>
+  std::size_t allocatedBytes(const std::vector<T, Allocator>& vec) {
+    return vec.capacity()*sizeof(T);
+  }
+
+}
@@ -8,6 +8,7 @@
 
 namespace phgasnets {
 
+  // Default gas constant of networks constructed without a Fluid
   extern double GAS_CONSTANT;
 
   /**
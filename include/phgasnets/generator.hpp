@@ -0,0 +1,56 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# pragma once
+
+# include "network.hpp"
+
+# include <vector>
+# include <Eigen/Core>
+# include <nlohmann/json.hpp>
+
+namespace phgasnets {
+
+  /**
+   * A synthetic chain of identical pipes joined by compressors, for scaling studies.
+   *
+   * Compressors default to fixed outlet pressure (FP/AM) stations restoring the inlet pressure,
+   * such that pressures stay bounded for arbitrarily long chains. Every pipe downstream of a
+   * compressor is at the compressor discharge temperature.
+   *
+   * The parameters may hold
+   *   "pipe"       {"length", "diameter", "friction"}, as for Pipe
+   *   "compressor" {"type", "model"}, the specification is set to the inlet pressure
+   *   "isentropic_exponent", "inlet_pressure" [Pa], "inlet_temperature" [K], "momentum",
+   *   "gas_constant" [J/(kg K)], the global default by default
+   * with defaults from the four_compressor_types demo, with 20km pipes.
+   */
+  struct SyntheticChain {
+      /**
+       * @param n_pipes number of pipes, joined by n_pipes-1 compressors
+       * @param params the chain parameters
+       *
+       * @throws std::invalid_argument if n_pipes is less than two
+       */
+      SyntheticChain(const int n_pipes, const nlohmann::json& params = nlohmann::json::object());
+
+      SyntheticChain(const SyntheticChain&) = delete;
+      SyntheticChain& operator=(const SyntheticChain&) = delete;
+
+      /**
+       * Initial guess of the steady state at the given resolution, at constant inlet pressure and momentum.
+       */
+      Eigen::VectorXd initial_guess(const int Nx) const;
+
+      public:
+        std::vector<Pipe> pipes;
+        std::vector<Compressor> compressors;
+        const Network network;
+        Eigen::VectorXd input;   // boundary input vector, two entries per pipe
+        double inlet_pressure, momentum;
+  };
+
+}
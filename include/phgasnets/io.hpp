@@ -8,17 +8,320 @@
 
 # include "network.hpp"
 
+# include <condition_variable>
+# include <deque>
+# include <exception>
+# include <mutex>
+# include <optional>
+# include <string>
+# include <thread>
+# include <vector>
+# include <Eigen/Core>
+# include <nlohmann/json.hpp>
 # include <highfive/H5Easy.hpp>
 
 namespace phgasnets{
 
+  /**
+   * Layout of the network states within the results file.
+   *
+   * Grouped:    one group per pipe and time step, `pipeN/<timetag>/{density,pressure,momentum,timestamp}`
+   * TimeSeries: one extendible (time x nodes) dataset per pipe and field, `pipeN/{density,pressure,momentum}`,
+   *             and a one-dimensional `time` dataset, all appended row by row
+   */
+  enum class OutputLayout { Grouped, TimeSeries };
+
+  OutputLayout outputLayoutFromString(const std::string& layout);
+
+  /**
+   * Process-wide lock of the HDF5 library, which most packaged builds compile without thread safety.
+   *
+   * The background thread of AsyncNetworkStateWriter writes under this lock, and so do the
+   * readers, checkpoints and steady state cache of this library. HDF5 calls of an application
+   * made while an AsyncNetworkStateWriter is open have to hold it as well.
+   */
+  std::recursive_mutex& hdf5Mutex();
+
+  /**
+   * Storage options of the network states.
+   *
+   * Pressure is redundant with density, as p = RT*rho for the ideal gas. Each pipe group carries
+   * its RT scale as attribute, such that pressure may be recomputed when write_pressure is disabled.
+   * For a real gas, pressure is always written and the groups carry no RT attribute.
+   */
+  struct OutputOptions {
+      OutputLayout layout = OutputLayout::Grouped;
+      std::size_t chunk_size = 64;     // time steps per chunk of the time series datasets
+      unsigned deflate_level = 0;      // gzip level 1-9, 0 disables compression
+      bool shuffle = false;            // byte shuffle before deflate
+      bool single_precision = false;   // store fields as float32, times remain double
+      bool write_pressure = true;
+      int space_stride = 1;            // write every space_stride-th node and the outlet node
+  };
+
+  /**
+   * Reads output options from the io section of a configuration file, e.g.
+   * {"layout": "timeseries", "compression": {"deflate": 4, "shuffle": true}, "precision": "single", "pressure": false, "stride": 4}
+   * Missing entries keep their defaults.
+   *
+   * @throws std::invalid_argument if the layout or precision is unknown, or the stride is not positive
+   */
+  OutputOptions outputOptionsFromJson(const nlohmann::json& io_params);
+
   struct NetworkStateWriter{
-      NetworkStateWriter(const std::string& filename, const DiscreteNetwork<double>& network);
+      /**
+       * Opens the results file for the network states.
+       *
+       * @param filename the HDF5 results file
+       * @param network the discretized network whose states are written
+       * @param append continue an existing file (e.g. on restart) instead of truncating it
+       * @param options layout, compression and precision of the stored states
+       *
+       * @throws std::runtime_error if an appended time series file was written with other nodes,
+       *         stride, precision or pressure datasets than the current options give
+       */
+      NetworkStateWriter(
+          const std::string& filename,
+          const DiscreteNetwork<double>& network,
+          const bool append = false,
+          const OutputOptions& options = OutputOptions()
+      );
       void writeMesh();
-      void writeState(const int& timetag, const int& time);
+      void writeState(const int& timetag, const double& time);
+
+      /**
+       * Writes the given network state instead of the current state of the network.
+       * Fields are written straight from the state buffer, unless they are strided or scaled.
+       *
+       * @param timetag the time step index
+       * @param time the simulation time [s]
+       * @param state full network state, laid out as in DiscreteNetwork::set_state
+       */
+      void writeState(const int& timetag, const double& time, const Eigen::Ref<const Eigen::VectorXd>& state);
+
+      /**
+       * Drops all time series rows written after the given time, e.g. those
+       * computed after the checkpoint a run is restarted from.
+       * Grouped files are left untouched, as their time steps are overwritten.
+       *
+       * @param time the last time [s] to keep
+       */
+      void discardAfter(const double time);
+
       private:
+        struct PipeDataSets {
+          HighFive::DataSet density;
+          std::optional<HighFive::DataSet> pressure;
+          HighFive::DataSet momentum;
+        };
+
+        HighFive::DataSet openOrCreateTimeSeries(
+            const std::string& path,
+            const std::size_t n_nodes,
+            const bool single_precision
+        );
+        HighFive::DataSetCreateProps fieldProperties(const std::vector<hsize_t>& chunk) const;
+        void writeField(const std::string& path, const double* data, const std::size_t n_nodes);
+        const double* gather(const std::size_t p, const double* field, Eigen::VectorXd& buffer) const;
+        void appendRow(HighFive::DataSet& dataset, const double* data, const std::size_t n_nodes);
+        void writePipeState(
+            const std::size_t p,
+            const int& timetag,
+            const double& time,
+            const double* rho,
+            const double* mom
+        );
+        void writeTime(const double& time);
+
         H5Easy::File file;
         const DiscreteNetwork<double>& network;
+        const H5Easy::DumpMode mode;
+        const OutputOptions options;
+        std::vector<std::vector<Eigen::Index>> pipe_nodes;
+        std::vector<PipeDataSets> pipe_datasets;
+        std::optional<HighFive::DataSet> time_dataset;
+        std::size_t n_rows;
+        Eigen::VectorXd rho_buffer, mom_buffer, pressure_buffer;
+  };
+
+  /**
+   * Writes network states on a background thread, such that the time loop does not stall on disk I/O.
+   *
+   * States are copied into one of a fixed pool of buffers allocated on construction.
+   * Once all buffers are queued, writeState() blocks until the background thread frees one,
+   * which bounds the memory use when the disk cannot keep up with the solver.
+   * Errors of the background thread are rethrown by the next call on the calling thread.
+   * An error still pending on destruction is reported on stderr, call flush() to receive it.
+   */
+  struct AsyncNetworkStateWriter{
+      /**
+       * Opens the results file for the network states and starts the background thread.
+       *
+       * @param filename the HDF5 results file
+       * @param network the discretized network whose states are written
+       * @param append continue an existing file (e.g. on restart) instead of truncating it
+       * @param options layout, compression and precision of the stored states
+       * @param queue_depth number of buffered states before writeState() blocks
+       */
+      AsyncNetworkStateWriter(
+          const std::string& filename,
+          const DiscreteNetwork<double>& network,
+          const bool append = false,
+          const OutputOptions& options = OutputOptions(),
+          const std::size_t queue_depth = 4
+      );
+
+      // Writes all queued states before closing the file
+      ~AsyncNetworkStateWriter();
+
+      AsyncNetworkStateWriter(const AsyncNetworkStateWriter&) = delete;
+      AsyncNetworkStateWriter& operator=(const AsyncNetworkStateWriter&) = delete;
+
+      void writeMesh();
+
+      /**
+       * Queues the given network state for writing.
+       *
+       * @param timetag the time step index
+       * @param time the simulation time [s]
+       * @param state full network state, laid out as in DiscreteNetwork::set_state
+       */
+      void writeState(const int& timetag, const double& time, const Eigen::Ref<const Eigen::VectorXd>& state);
+
+      void discardAfter(const double time);
+
+      /**
+       * Blocks until all queued states are written.
+       */
+      void flush();
+
+      // Total wall time the background thread spent writing states [s]
+      double write_time() const;
+
+      private:
+        struct Job {
+          std::size_t buffer;
+          int timetag;
+          double time;
+        };
+
+        void run();
+        void rethrow();
+
+        std::optional<NetworkStateWriter> writer;   // opened and closed under the HDF5 lock
+        std::vector<Eigen::VectorXd> buffers;
+        std::vector<std::size_t> free_buffers;
+        std::deque<Job> jobs;
+        bool writing, stop;
+        double total_write_time;
+        std::exception_ptr error;
+        mutable std::mutex mutex;
+        std::condition_variable job_queued, job_done;
+        std::thread worker;
+  };
+
+  /**
+   * Reads network states written by NetworkStateWriter, in either layout.
+   *
+   * Time steps are indexed in the order of their timetags. Time series files are read by
+   * hyperslab selection of a single row, grouped files by opening the group of the time step.
+   * Fields stored in single precision are converted to double on read.
+   */
+  struct NetworkStateReader{
+      /**
+       * Opens a results file and indexes its time steps.
+       *
+       * @param filename the HDF5 results file
+       * @param network a discretized network of the same pipes and resolution as the written one
+       *
+       * @throws std::runtime_error if the file was written with a space stride or another resolution
+       */
+      NetworkStateReader(const std::string& filename, const DiscreteNetwork<double>& network);
+
+      // Closes the file under the HDF5 lock
+      ~NetworkStateReader();
+
+      NetworkStateReader(const NetworkStateReader&) = delete;
+      NetworkStateReader& operator=(const NetworkStateReader&) = delete;
+
+      std::size_t size() const { return time_steps.size(); }
+      const std::vector<double>& times() const { return time_steps; }
+
+      /**
+       * Finds the last time step at or before the given time.
+       *
+       * @throws std::out_of_range if the time precedes the first time step
+       */
+      std::size_t index_at(const double time) const;
+
+      /**
+       * Reads the full network state of a time step, laid out as in DiscreteNetwork::set_state.
+       *
+       * @throws std::out_of_range if the index exceeds the number of time steps
+       */
+      Eigen::VectorXd state(const std::size_t index) const;
+
+      /**
+       * Reads a time step into the network, e.g. to warm start a simulation.
+       */
+      void load(const std::size_t index, DiscreteNetwork<double>& network) const;
+
+      /**
+       * Reads the full history of one field of a pipe, pressure is recovered from density if not stored.
+       *
+       * @param pipe the pipe index
+       * @param field one of density, pressure or momentum
+       *
+       * @return (time x nodes) matrix
+       */
+      Eigen::MatrixXd history(const std::size_t pipe, const std::string& field) const;
+
+      private:
+        std::vector<double> readPipeField(const std::size_t pipe, const std::string& field, const std::size_t index) const;
+
+        std::optional<H5Easy::File> file;
+        OutputLayout layout;
+        const DiscreteNetwork<double>& network;
+        std::vector<std::string> timetags;   // grouped layout only
+        std::vector<double> time_steps;
+  };
+
+  /**
+   * Everything needed to resume a transient simulation without recomputing the steady state.
+   */
+  struct Checkpoint {
+      std::string network_hash;  // network_hash() of the network and spatial discretization
+      Eigen::VectorXd state;  // full network state
+      Eigen::VectorXd input;  // boundary input vector of the last step
+      double time;            // simulation time [s]
+      int step;               // time step index, i.e. the boundary cursor
+      double timestep;        // time step size [s]
+      double function_tolerance;
+      int max_num_iterations;
   };
 
+  /**
+   * Writes a checkpoint to an HDF5 file.
+   *
+   * The file is first written under a temporary name and then renamed,
+   * such that an interruption never leaves a corrupt checkpoint behind.
+   *
+   * @param filename the HDF5 checkpoint file
+   * @param checkpoint the checkpoint to write
+   *
+   * @throws std::runtime_error if the checkpoint cannot be moved in place
+   */
+  void writeCheckpoint(const std::string& filename, const Checkpoint& checkpoint);
+
+  /**
+   * Reads a checkpoint from an HDF5 file.
+   *
+   * @param filename the HDF5 checkpoint file
+   *
+   * @return the stored checkpoint
+   *
+   * @throws HighFive::Exception if the file or a dataset does not exist
+   */
+  Checkpoint readCheckpoint(const std::string& filename);
+
 }
@@ -9,26 +9,59 @@
 # include "operators.hpp"
 # include "pipe.hpp"
 # include "compressor.hpp"
+# include "fluid.hpp"
 # include "utils.hpp"
+# include "trace.hpp"
 
 # include <nlohmann/json.hpp>
 # include <ceres/jet.h>
+# include <algorithm>
+# include <functional>
+# include <memory>
+# include <stdexcept>
+# include <string>
+# include <typeindex>
+# include <unordered_map>
 # include <vector>
 
 namespace phgasnets {
 
+  /**
+   * Assembled static operators of every pipe of a network at one resolution, e.g. memory-mapped
+   * from a NetworkSnapshot, which keeps its mapping alive in storage.
+   */
+  struct StaticOperators {
+    int resolution;
+    std::vector<StaticPipeOperators> pipes;
+    std::shared_ptr<const void> storage;
+  };
+
   struct Network{
     Network(
       std::vector<Pipe>& pipes,
-      std::vector<Compressor>& compressors
-    ): pipes(pipes), compressors(compressors)
+      std::vector<Compressor>& compressors,
+      const Fluid& fluid = Fluid(),
+      std::shared_ptr<const StaticOperators> operators = nullptr
+    ): pipes(pipes), compressors(compressors), fluid(fluid), operators(operators)
     {}
 
+    // Pressure factor p/rho of a pipe
+    double RT(const int pipe) const { return fluid.RT(pipes[pipe].temperature); }
+
     public:
       std::vector<Pipe>& pipes;
       std::vector<Compressor>& compressors;
+      Fluid fluid;
+      std::shared_ptr<const StaticOperators> operators;   // adopted by discretize() at their resolution, if any
   };
 
+  /**
+   * A discretized chain of pipes, where compressor k joins the outlet of pipe k to the inlet of pipe k+1.
+   *
+   * The input vector holds two entries per pipe: the inlet pressure of the first pipe,
+   * the coupling factor and specification of each compressor, and the negated outlet momentum
+   * of the last pipe.
+   */
   template<typename T>
   struct DiscreteNetwork {
 
@@ -38,12 +71,12 @@ namespace phgasnets {
     ):
       pipes(pipes), compressors(compressors), n_state(0), n_res(0)
     {
-      // diagonally block static operators
-      std::vector<std::reference_wrapper<BaseOperator<double>>> operators_e, operators_j;
+      // diagonally block static operators from their matrices, which adopted operators hold without triplets
+      std::vector<std::reference_wrapper<const Eigen::SparseMatrix<double>>> operators_e, operators_j;
       std::vector<std::reference_wrapper<BaseOperator<T>>> operators_r, operators_g;
-      for (auto& pipe: pipes) {
-        operators_e.push_back(std::ref(pipe.Et));
-        operators_j.push_back(std::ref(pipe.Jt));
+      for (auto& pipe: this->pipes) {
+        operators_e.push_back(std::cref(pipe.Et.mat));
+        operators_j.push_back(std::cref(pipe.Jt.mat));
         operators_r.push_back(std::ref(pipe.Rt));
         operators_g.push_back(std::ref(pipe.G));
         n_state += pipe.n_state;
@@ -54,9 +87,13 @@ namespace phgasnets {
       R = diagonalBlock<T>(operators_r);
       G = diagonalBlock<T>(operators_g);
       effort.resize(n_res);
+      midpoint.resize(n_state);
+      rate.resize(n_state);
     };
 
     void set_state(const Eigen::Ref<const Eigen::Vector<T, Eigen::Dynamic>>& state) {
+      PHGASNETS_TRACE_SCOPE("set_state");
+
       // distribute state across network constituents
       int pipe_state_startIdx = 0;
       for (auto& pipe : pipes) {
@@ -65,34 +102,57 @@ namespace phgasnets {
         pipe_state_startIdx += pipe.n_state;
       }
 
-      // update pipe-specific R and effort
-      std::vector<std::reference_wrapper<BaseOperator<T>>> operators_r, operators_g;
-
+      // update network R operator and effort in place, the pattern of R is
+      // the diagonal block of the pipe patterns, in column-major order
       int pipe_res_startIdx = 0;
+      T* r_values = R.valuePtr();
       for(auto& pipe : pipes){
-        operators_r.push_back(std::ref(pipe.Rt));
+        r_values = std::copy_n(pipe.Rt.mat.valuePtr(), pipe.Rt.mat.nonZeros(), r_values);
+        eigen_assert(r_values <= R.valuePtr() + R.nonZeros());
         effort(Eigen::seqN(pipe_res_startIdx, pipe.n_res)) = pipe.effort.vec_t;
         pipe_res_startIdx += pipe.n_res;
       }
 
-      // build network R operator
-      R = diagonalBlock<T>(operators_r);
+      // update network G operator, compressor k couples the outlet of pipe k to the inlet of pipe k+1
+      int upstream_res_startIdx = 0;
+      for (int k = 0; k < compressors.size(); ++k) {
+        const auto& upstream = pipes[k];
+        const auto& downstream = pipes[k+1];
+        const int downstream_res_startIdx = upstream_res_startIdx + upstream.n_res;
 
-      // update network G operator
-      auto precompressor_pressure = phgasnets::GAS_CONSTANT * pipes[0].temperature * pipes[0].rho(Eigen::last);
-      auto postcompressor_momentum = pipes[1].mom(0);
+        auto precompressor_pressure = upstream.pressure(upstream.rho(Eigen::last));
+        auto postcompressor_momentum = downstream.mom(0);
 
-      G.coeffRef(pipes[0].n_res-1, 1) = -postcompressor_momentum;
-      if (compressors[0].type == "FC") {
-        G.coeffRef(pipes[0].n_res+pipes[1].n_res-2, 2) = T(precompressor_pressure);
-      }
-      else {
-        if (compressors[0].type == "FP" && compressors[0].model == "AV") {
-          G.coeffRef(pipes[0].n_res-1, 1) *= ceres::pow(precompressor_pressure, 1.0/compressors[0].isentropic_exponent);
+        G.coeffRef(downstream_res_startIdx-1, 2*k+1) = -postcompressor_momentum;
+        if (compressors[k].type == "FC") {
+          G.coeffRef(downstream_res_startIdx+downstream.n_res-2, 2*k+2) = T(precompressor_pressure);
         }
+        else {
+          if (compressors[k].type == "FP" && compressors[k].model == "AV") {
+            G.coeffRef(downstream_res_startIdx-1, 2*k+1) *= ceres::pow(precompressor_pressure, 1.0/compressors[k].isentropic_exponent);
+          }
+        }
+        upstream_res_startIdx = downstream_res_startIdx;
       }
     }
 
+    /**
+     * Memory held by the network operators, effort and workspaces, and by all pipes,
+     * aggregated over pipes under "pipes".
+     */
+    MemoryFootprint footprint() const {
+      MemoryFootprint memory;
+      for (const auto& pipe : pipes)
+        memory.add("pipes", pipe.footprint());
+      memory.add("E", allocatedBytes(E));
+      memory.add("J", allocatedBytes(J));
+      memory.add("R", allocatedBytes(R));
+      memory.add("G", allocatedBytes(G));
+      memory.add("effort", allocatedBytes(effort));
+      memory.add("workspaces", allocatedBytes(midpoint) + allocatedBytes(rate));
+      return memory;
+    }
+
     public:
       std::vector<DiscretePipe<T>> pipes;
       std::vector<Compressor> compressors;
@@ -100,17 +160,69 @@ namespace phgasnets {
       Eigen::SparseMatrix<T> R, G;
       Eigen::Vector<T, Eigen::Dynamic> effort;
       int n_state, n_res;
+
+      // Workspaces of the residual evaluation, allocated once
+      Eigen::Vector<T, Eigen::Dynamic> midpoint, rate;
   };
 
   template<typename T>
   DiscreteNetwork<T> discretize(const Network& network, const nlohmann::json& spatial_disc_params){
+    PHGASNETS_TRACE_SCOPE("discretize");
 
     std::vector<DiscretePipe<T>> discrete_pipes;
     int Nx = spatial_disc_params["resolution"];
 
-    for (auto& pipe: network.pipes)
-      discrete_pipes.push_back(DiscretePipe<T>(pipe, Nx));
+    // Static operators are adopted if given at this resolution, and assembled otherwise
+    const StaticOperators* operators = network.operators && network.operators->resolution == Nx ? network.operators.get() : nullptr;
+    if (operators && operators->pipes.size() != network.pipes.size())
+      throw std::invalid_argument("Static operators are given for " + std::to_string(operators->pipes.size()) + " pipes, the network has " + std::to_string(network.pipes.size()) + ".");
+
+    for (int p = 0; p < network.pipes.size(); ++p)
+      discrete_pipes.push_back(DiscretePipe<T>(network.pipes[p], Nx, network.fluid, operators ? &operators->pipes[p] : nullptr));
 
     return DiscreteNetwork<T>(discrete_pipes, network.compressors);
   }
+
+  /**
+   * Discretizations of a network, one per scalar type, built on first use.
+   *
+   * Residual functors hold one instead of a function-local static, which would tie
+   * every instance to the network and resolution of the first call.
+   */
+  struct DiscreteNetworkCache {
+    DiscreteNetworkCache(
+      const Network& network,
+      const nlohmann::json& spatial_disc_params
+    ): network(network), spatial_disc_params(spatial_disc_params)
+    {}
+
+    template<typename T>
+    DiscreteNetwork<T>& get() {
+      auto& entry = networks[std::type_index(typeid(T))];
+      if (!entry.network) {
+        auto discrete_network = std::make_shared<DiscreteNetwork<T>>(discretize<T>(network, spatial_disc_params));
+        entry.footprint = [discrete_network = discrete_network.get()] { return discrete_network->footprint(); };
+        entry.network = discrete_network;
+      }
+      return *static_cast<DiscreteNetwork<T>*>(entry.network.get());
+    }
+
+    // Memory held by the discretizations built so far, under "double" and "jet"
+    MemoryFootprint footprint() const {
+      MemoryFootprint memory;
+      for (const auto& entry : networks)
+        memory.add(entry.first == std::type_index(typeid(double)) ? "double" : "jet", entry.second.footprint());
+      return memory;
+    }
+
+    private:
+      struct Entry {
+        std::shared_ptr<void> network;
+        std::function<MemoryFootprint()> footprint;
+      };
+
+      const Network& network;
+      const nlohmann::json& spatial_disc_params;
+      std::unordered_map<std::type_index, Entry> networks;
+  };
 } // namespace phgasnets
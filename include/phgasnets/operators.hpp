@@ -8,7 +8,11 @@
 
 # include "derivative.hpp"
 # include "gasconstant.hpp"
+# include "footprint.hpp"
+# include "eos.hpp"
 
+# include <algorithm>
+# include <optional>
 # include <vector>
 # include <Eigen/Core>
 # include <Eigen/SparseCore>
@@ -33,6 +37,13 @@ namespace phgasnets {
         const int n_mom
     ): n_rho(n_rho), n_mom(n_mom) {}
 
+    // Adopts an assembled matrix, e.g. of a NetworkSnapshot, without a triplet list
+    BaseOperator(
+        const int n_rho,
+        const int n_mom,
+        const Eigen::Ref<const Eigen::SparseMatrix<T>>& mat
+    ): n_rho(n_rho), n_mom(n_mom), mat(mat) {}
+
     // Update State
     void update_state(
       const Eigen::Ref<const Eigen::Vector<T, Eigen::Dynamic>>&,
@@ -49,6 +60,14 @@ namespace phgasnets {
         mat.coeffRef(i, j) = value;
     }
 
+    // Memory held by the triplet list and the matrix, overloaded by operators built from others
+    virtual MemoryFootprint footprint() const {
+        MemoryFootprint memory;
+        memory.add("triplets", allocatedBytes(data));
+        memory.add("matrix", allocatedBytes(mat));
+        return memory;
+    }
+
     // Destructor
     virtual ~BaseOperator() = default;
 
@@ -66,8 +85,14 @@ namespace phgasnets {
           const int n_rho,
           const int n_mom
       );
+      Et_operator(
+          const int n_rho,
+          const int n_mom,
+          const Eigen::Ref<const Eigen::SparseMatrix<double>>& mat
+      );
+      MemoryFootprint footprint() const override;
       private:
-          const E_operator E;
+          std::optional<const E_operator> E;   // empty if adopted
   };
 
   struct U_operator: BaseOperator<double>{
@@ -93,9 +118,15 @@ namespace phgasnets {
           const int n_mom,
           const double mesh_width
       );
+      Jt_operator(
+          const int n_rho,
+          const int n_mom,
+          const Eigen::Ref<const Eigen::SparseMatrix<double>>& mat
+      );
+      MemoryFootprint footprint() const override;
       private:
-          const J_operator J;
-          const U_operator U;
+          std::optional<const J_operator> J;   // empty if adopted
+          std::optional<const U_operator> U;
   };
 
   struct Y_operator: BaseOperator<double>{
@@ -121,25 +152,23 @@ namespace phgasnets {
       BaseOperator<T>(n_rho, n_mom), f(friction), D(diameter)
     {
       this->data.resize(n_mom);
+      for (int i = 0; i < n_mom; ++i)
+        this->data[i] = Eigen::Triplet<T>(n_rho+i, n_rho+i, T(0.0));
       this->mat.resize(n_rho+n_mom, n_rho+n_mom);
+      this->mat.setFromTriplets(this->data.begin(), this->data.end());
     }
 
     // (Overloaded) Update State
+    // The diagonal pattern is fixed on construction, values are updated in place without allocation
     void update_state(
         const Eigen::Ref<const Eigen::Vector<T, Eigen::Dynamic>>& rho,
         const Eigen::Ref<const Eigen::Vector<T, Eigen::Dynamic>>& mom
     ) {
-
+        T* values = this->mat.valuePtr();
         for (int i = 0; i < this->n_mom; ++i) {
-          auto friction_term = ceres::abs(f * mom(i)/rho(i) / (2 * D));
-          this->data[i] = Eigen::Triplet<T>(
-            this->n_rho+i, this->n_rho+i, friction_term
-          );
+          values[i] = ceres::abs(f * mom(i)/rho(i) / (2 * D));
+          this->data[i] = Eigen::Triplet<T>(this->n_rho+i, this->n_rho+i, values[i]);
         }
-
-        this->mat.setFromTriplets(
-          this->data.begin(), this->data.end(), [] (const T&, const T& b) { return b; }
-        );
     }
   }; // struct R_operator
 
@@ -159,8 +188,9 @@ namespace phgasnets {
         BaseOperator<T>(n_rho, n_mom),
         R(R_operator<T>(n_rho, n_mom, friction, diameter))
     {
-        this->data.resize(n_mom);
+        this->data = R.data;
         this->mat.resize(n_rho+n_mom+2, n_rho+n_mom+2);
+        this->mat.setFromTriplets(this->data.begin(), this->data.end());
     }
 
     void update_state(
@@ -169,11 +199,15 @@ namespace phgasnets {
     ) {
       // Update the R_operator
       R.update_state(rho, mom);
-      // Update self
+      // Update self, with the same pattern as R
       this->data = R.data;
-      this->mat.setFromTriplets(
-        this->data.begin(), this->data.end(), [] (const T&, const T& b) { return b; }
-      );
+      std::copy_n(R.mat.valuePtr(), R.mat.nonZeros(), this->mat.valuePtr());
+    }
+
+    MemoryFootprint footprint() const override {
+      MemoryFootprint memory = BaseOperator<T>::footprint();
+      memory.add("R", R.footprint());
+      return memory;
     }
   }; // struct Rt_operator
 
@@ -186,16 +220,18 @@ namespace phgasnets {
       Eigen::Vector<T, Eigen::Dynamic> vec;
 
     public:
-      double temperature;
+      double RT;
+      const PressureTable* pressure_table;   // real gas pressure, or nullptr for the ideal gas rho*RT
       Eigen::Vector<T, Eigen::Dynamic> vec_t;
 
       effortVec(
         const int n_rho,
         const int n_mom,
-        const double temperature
+        const double RT,
+        const PressureTable* pressure_table = nullptr
       ) :
       n_rho(n_rho), n_mom(n_mom), Y(Y_operator(n_rho, n_mom)),
-      temperature(temperature),
+      RT(RT), pressure_table(pressure_table),
       vec(n_rho+n_mom), vec_t(n_rho+n_mom+2)
       {}
 
@@ -203,11 +239,22 @@ namespace phgasnets {
         const Eigen::Ref<const Eigen::Vector<T, Eigen::Dynamic>>& rho,
         const Eigen::Ref<const Eigen::Vector<T, Eigen::Dynamic>>& mom
       ){
-        vec.segment(0, n_rho) = rho * phgasnets::GAS_CONSTANT * temperature;
+        if (pressure_table)
+          for (int i = 0; i < n_rho; ++i)
+            vec(i) = pressure_table->pressure(rho(i));
+        else
+          vec.segment(0, n_rho) = rho * RT;
         vec.segment(n_rho, n_mom) = mom;
 
         vec_t.segment(0, n_rho+n_mom) = vec;
-        vec_t.segment(n_rho+n_mom, 2) = Y.mat * vec;
+        vec_t.segment(n_rho+n_mom, 2).noalias() = Y.mat * vec;
+      }
+
+      MemoryFootprint footprint() const {
+        MemoryFootprint memory;
+        memory.add("Y", Y.footprint());
+        memory.add("vectors", allocatedBytes(vec) + allocatedBytes(vec_t));
+        return memory;
       }
   };
 
@@ -0,0 +1,150 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# pragma once
+
+# include "network.hpp"
+
+# include <algorithm>
+# include <limits>
+# include <memory>
+# include <string>
+# include <vector>
+# include <Eigen/Core>
+# include <nlohmann/json.hpp>
+
+namespace phgasnets {
+
+  /**
+   * A named sensor location along a pipe.
+   */
+  struct Probe {
+      std::string name;
+      int pipe;          // pipe index within the network
+      double position;   // distance from the pipe inlet [m]
+  };
+
+  /**
+   * Reads probes from a list of {"name": ..., "pipe": ..., "position": ...} entries.
+   */
+  std::vector<Probe> probesFromJson(const nlohmann::json& locations);
+
+  /**
+   * Minimum, maximum and mean of a sequence of values, accumulated online.
+   */
+  struct RunningStatistics {
+      void add(const double value) {
+        ++count;
+        min = std::min(min, value);
+        max = std::max(max, value);
+        mean += (value - mean)/count;
+      }
+
+      nlohmann::json to_json() const {
+        return {{"min", min}, {"max", max}, {"mean", mean}, {"count", count}};
+      }
+
+      public:
+        long count = 0;
+        double min = std::numeric_limits<double>::infinity();
+        double max = -std::numeric_limits<double>::infinity();
+        double mean = 0.0;
+  };
+
+  /**
+   * Records pressure and momentum at probe locations, linearly interpolated between mesh nodes.
+   *
+   * Time series are kept for every frequency-th recorded time step only, while
+   * statistics of each probe accumulate over all recorded time steps.
+   */
+  struct ProbeRecorder {
+      /**
+       * @param network the discretized network the probes are placed in
+       * @param probes the probe locations
+       * @param frequency keep every frequency-th time step in the time series
+       *
+       * @throws std::invalid_argument if the frequency is less than 1
+       * @throws std::out_of_range if a probe refers to a non-existing pipe or lies outside of its pipe
+       */
+      ProbeRecorder(
+          const DiscreteNetwork<double>& network,
+          const std::vector<Probe>& probes,
+          const int frequency = 1
+      );
+
+      /**
+       * Evaluates the probes for the given network state.
+       *
+       * @param timetag the time step index, for decimation
+       * @param time the simulation time [s]
+       * @param state full network state, laid out as in DiscreteNetwork::set_state
+       */
+      void record(const int timetag, const double time, const Eigen::Ref<const Eigen::VectorXd>& state);
+
+      /**
+       * Writes the time series as columns time [s], <name>_pressure [Pa] and <name>_momentum.
+       */
+      void writeCSV(const std::string& filename) const;
+
+      /**
+       * Streams the time series of all following records to a CSV file, with the columns of writeCSV(),
+       * instead of keeping them in memory. Statistics are accumulated as before.
+       *
+       * @throws std::runtime_error if the file cannot be opened
+       */
+      void streamCSV(const std::string& filename);
+
+      nlohmann::json statistics() const;
+
+      // Accessors
+      const std::vector<double>& times() const { return time_series; }
+      const std::vector<double>& pressure(const std::size_t probe) const { return pressure_series[probe]; }
+      const std::vector<double>& momentum(const std::size_t probe) const { return momentum_series[probe]; }
+
+      public:
+        const std::vector<Probe> probes;
+        const int frequency;
+
+      private:
+        struct Stencil {
+          int left;        // state index of the density left of the probe
+          int n_rho;       // offset from density to momentum
+          double weight;   // weight of the right node
+          double RT;
+          std::shared_ptr<const PressureTable> pressure_table;   // empty for the ideal gas
+        };
+
+        std::vector<Stencil> stencils;
+        std::vector<double> time_series;
+        std::vector<std::vector<double>> pressure_series, momentum_series;
+        std::vector<RunningStatistics> pressure_stats, momentum_stats;
+        std::unique_ptr<CSVWriter> csv;
+        std::vector<double> row;
+  };
+
+  /**
+   * Accumulates online statistics of the network: pressure range per pipe and linepack,
+   * the gas mass stored in each pipe, integrated with the trapezoidal rule.
+   */
+  struct NetworkStatistics {
+      NetworkStatistics(const DiscreteNetwork<double>& network);
+
+      void record(const Eigen::Ref<const Eigen::VectorXd>& state);
+
+      /**
+       * Computes the linepack [kg] of each pipe for the given network state.
+       */
+      Eigen::VectorXd linepack(const Eigen::Ref<const Eigen::VectorXd>& state) const;
+
+      nlohmann::json to_json() const;
+
+      private:
+        const DiscreteNetwork<double>& network;
+        std::vector<RunningStatistics> pressure_min, pressure_max, pipe_linepack;
+        RunningStatistics total_linepack;
+  };
+
+}
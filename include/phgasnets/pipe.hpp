@@ -7,11 +7,14 @@
 # pragma once
 
 # include "operators.hpp"
+# include "fluid.hpp"
 # include <Eigen/Core>
 # include <Eigen/SparseCore>
 # include <nlohmann/json.hpp>
 # include <vector>
 # include <memory>
+# include <stdexcept>
+# include <string>
 # include <unordered_map>
 
 namespace phgasnets{
@@ -40,34 +43,54 @@ namespace phgasnets{
 
   };
 
+  /**
+   * Assembled static operators of a discrete pipe, e.g. memory-mapped from a NetworkSnapshot.
+   */
+  struct StaticPipeOperators {
+    Eigen::Map<const Eigen::SparseMatrix<double>> Et, Jt;
+  };
+
   template <typename T>
   struct DiscretePipe{
 
+    /**
+     * Discretizes a pipe with nx cells, adopting the given static operators instead of
+     * assembling them from triplets, if any.
+     *
+     * @throws std::invalid_argument if the given operators do not match the resolution
+     */
     DiscretePipe(
       const float length,
       const float diameter,
       const float friction,
       const float temperature,
-      const int nx
+      const int nx,
+      const Fluid& fluid,
+      const StaticPipeOperators* operators = nullptr
     ):
     length(length), diameter(diameter), friction(friction),
     n_x(nx), mesh_width(length/nx),  mesh(nx+1),
     n_rho(nx+1), n_mom(nx+1), n_res(2*nx+4), n_state(2*nx+2),
     rho(n_x+1), mom(nx+1),
-    temperature(temperature),
-    Et(Et_operator(n_x+1, n_x+1)),
-    Jt(Jt_operator(n_x+1, n_x+1, mesh_width)),
+    temperature(temperature), RT(fluid.RT(temperature)),
+    pressure_table(fluid.ideal() ? nullptr : std::make_shared<const PressureTable>(fluid.eos, fluid.gas_constant, temperature, fluid.table)),
+    Et(operators ? Et_operator(n_x+1, n_x+1, operators->Et) : Et_operator(n_x+1, n_x+1)),
+    Jt(operators ? Jt_operator(n_x+1, n_x+1, operators->Jt) : Jt_operator(n_x+1, n_x+1, mesh_width)),
     Rt(Rt_operator<T>(n_x+1, n_x+1, friction, diameter)),
-    effort(effortVec<T>(n_rho, n_mom, temperature)),
+    effort(effortVec<T>(n_rho, n_mom, RT, pressure_table.get())),
     G(G_operator<T>(n_x+1, n_x+1))
     {
+      if (operators && (Et.mat.rows() != n_res || Et.mat.cols() != n_state || Jt.mat.rows() != n_res || Jt.mat.cols() != n_res))
+        throw std::invalid_argument("Static operators do not match a pipe of " + std::to_string(nx) + " cells.");
       mesh = Eigen::VectorXd::LinSpaced(n_x+1, 0.0, length);
     }
 
     DiscretePipe(
       const Pipe& pipe,
-      const int nx
-    ): DiscretePipe(pipe.length, pipe.diameter, pipe.friction, pipe.temperature, nx)
+      const int nx,
+      const Fluid& fluid,
+      const StaticPipeOperators* operators = nullptr
+    ): DiscretePipe(pipe.length, pipe.diameter, pipe.friction, pipe.temperature, nx, fluid, operators)
     {}
 
     virtual ~DiscretePipe() = default; // Destructor
@@ -81,6 +104,37 @@ namespace phgasnets{
       effort.update_state(rho, mom);
     }
 
+    // Pressure at density, interpolated in the table of a real gas
+    template<typename S>
+    S pressure(const S& density) const {
+      return pressure_table ? pressure_table->pressure(density) : S(density*RT);
+    }
+
+    // Derivative of the pressure with respect to density
+    double pressure_derivative(const double density) const {
+      return pressure_table ? pressure_table->pressure_derivative(density) : RT;
+    }
+
+    // Density at pressure
+    double density(const double pressure) const {
+      return pressure_table ? pressure_table->density(pressure) : pressure/RT;
+    }
+
+    // Memory held by the operators, state vectors and mesh
+    MemoryFootprint footprint() const {
+      MemoryFootprint memory;
+      memory.add("Et", Et.footprint());
+      memory.add("Jt", Jt.footprint());
+      memory.add("Rt", Rt.footprint());
+      memory.add("G", G.footprint());
+      memory.add("effort", effort.footprint());
+      memory.add("state", allocatedBytes(rho) + allocatedBytes(mom));
+      memory.add("mesh", allocatedBytes(mesh));
+      if (pressure_table)
+        memory.add("pressure_table", pressure_table->bytes());
+      return memory;
+    }
+
     public:
       const int n_x;
       const int n_rho;
@@ -92,6 +146,8 @@ namespace phgasnets{
       const float friction;
       const float mesh_width;
       float temperature;
+      const double RT;   // pressure factor p/rho of the fluid at the pipe temperature
+      std::shared_ptr<const PressureTable> pressure_table;   // p(rho) of a real gas, empty for the ideal gas
       Eigen::VectorXd mesh;
       Eigen::Vector<T, Eigen::Dynamic> rho, mom;
       Et_operator Et;
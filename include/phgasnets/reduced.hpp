@@ -0,0 +1,224 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# pragma once
+
+# include "network.hpp"
+# include "compressor.hpp"
+
+# include <stdexcept>
+# include <string>
+# include <vector>
+# include <Eigen/Core>
+# include <nlohmann/json.hpp>
+# include <ceres/jet.h>
+
+namespace phgasnets {
+
+  /**
+   * Collects full-order network states from transient runs as snapshot columns.
+   */
+  struct Snapshots {
+      void add(const Eigen::Ref<const Eigen::VectorXd>& state);
+      Eigen::MatrixXd matrix() const;
+
+      public:
+        std::vector<Eigen::VectorXd> states;
+  };
+
+  /**
+   * Computes an orthonormal POD basis of the snapshot columns.
+   *
+   * @param snapshots matrix with one snapshot per column
+   * @param tolerance truncation tolerance on the discarded singular value energy
+   * @param max_rank upper bound on the number of basis vectors
+   *
+   * @return matrix whose columns are the leading left singular vectors
+   *
+   * @throws None
+   */
+  Eigen::MatrixXd pod_basis(
+      const Eigen::Ref<const Eigen::MatrixXd>& snapshots,
+      const double tolerance,
+      const int max_rank
+  );
+
+  /**
+   * Selects interpolation indices of a basis with the greedy DEIM procedure.
+   *
+   * @param basis matrix whose columns span the nonlinear term
+   *
+   * @return row indices, one per basis column
+   *
+   * @throws None
+   */
+  std::vector<int> deim_indices(const Eigen::Ref<const Eigen::MatrixXd>& basis);
+
+  /**
+   * Reduced pipe: density and momentum bases kept separate such that the
+   * projection respects the block structure of the port-Hamiltonian operators.
+   */
+  struct ReducedPipe {
+      int n_rho, n_mom; // reduced ranks
+      int n_state, n_res;
+      double RT, friction, diameter;
+      Eigen::MatrixXd V_rho, V_mom;
+      Eigen::VectorXd rho_ref, mom_ref;
+
+      // DEIM hyper-reduction of the friction term f |m/rho| m / 2D
+      std::vector<int> deim_nodes;
+      Eigen::MatrixXd deim_projector; // V_mom^T U (P^T U)^{-1}
+      Eigen::MatrixXd V_rho_sampled, V_mom_sampled;
+      Eigen::VectorXd rho_ref_sampled, mom_ref_sampled;
+  };
+
+  /**
+   * Galerkin projection of a DiscreteNetwork onto per-pipe POD bases.
+   *
+   * With V the block-diagonal state basis and W = diag(V_pipe, I_2) the test basis,
+   * the reduced operators are E_r = W^T E V, J_r = W^T J W and the friction term W^T R e
+   * is approximated by DEIM. The boundary rows of each pipe are kept as is.
+   */
+  struct ReducedNetwork {
+      Eigen::VectorXd project(const Eigen::Ref<const Eigen::VectorXd>& state) const;
+      Eigen::VectorXd lift(const Eigen::Ref<const Eigen::VectorXd>& reduced_state) const;
+
+      public:
+        std::vector<ReducedPipe> pipes;
+        std::vector<Compressor> compressors;
+        Eigen::MatrixXd E, J;
+        Eigen::VectorXd J_ref; // W^T J e(z_ref)
+        int n_state, n_res;
+  };
+
+  /**
+   * Builds the reduced network from full-order snapshots.
+   *
+   * @param network the discretized full-order network
+   * @param snapshots matrix of full-order states, one per column; the first column is the reference state
+   * @param rom_params json with "tolerance", "max_rank" and "deim_rank"
+   *
+   * @return the reduced network
+   *
+   * @throws std::invalid_argument for a real gas, as the reduced effort is linear in density
+   */
+  ReducedNetwork reduce(
+      const DiscreteNetwork<double>& network,
+      const Eigen::Ref<const Eigen::MatrixXd>& snapshots,
+      const nlohmann::json& rom_params
+  );
+
+  /**
+   * Transient residual of a reduced network, with the boundary and compressor coupling of DiscreteNetwork.
+   *
+   * The input vector holds two entries per pipe, as for DiscreteNetwork.
+   */
+  struct ReducedTransientCompressorSystem{
+      /**
+       * @throws std::invalid_argument if the network is not a chain of pipes joined by compressors,
+       *         or the input does not hold two entries per pipe
+       */
+      ReducedTransientCompressorSystem(
+          const ReducedNetwork& network,
+          const nlohmann::json& disc_params,
+          const Eigen::Ref<const Eigen::VectorXd>& current_state,
+          const Eigen::Ref<const Eigen::VectorXd>& input_vec
+      ):
+          network(network), current_state(current_state),
+          input_vec(input_vec), timestep(disc_params["time"]["step"])
+      {
+        if (network.pipes.empty() || network.compressors.size() != network.pipes.size()-1)
+          throw std::invalid_argument("A reduced network has to be a chain of pipes joined by compressors.");
+        if (input_vec.size() != 2*network.pipes.size())
+          throw std::invalid_argument("The input of a reduced network holds two entries per pipe, got " + std::to_string(input_vec.size()) + ".");
+      }
+
+      template <typename T>
+      bool operator()(
+          T const* const* guess_state,
+          T* residual
+      ) const {
+          Eigen::Map<const Eigen::Vector<T, Eigen::Dynamic>> new_state(guess_state[0], network.n_state);
+          Eigen::Map<Eigen::Vector<T, Eigen::Dynamic>> r(residual, network.n_res);
+
+          // Implicit midpoint rule
+          Eigen::Vector<T, Eigen::Dynamic> z = (new_state + current_state) * 0.5;
+          Eigen::Vector<T, Eigen::Dynamic> dz_dt = (new_state - current_state) / timestep;
+
+          // Reduced effort: pressure and momentum coefficients, boundary entries do not enter J
+          Eigen::Vector<T, Eigen::Dynamic> effort = Eigen::Vector<T, Eigen::Dynamic>::Zero(network.n_res);
+          int state_startIdx = 0, res_startIdx = 0;
+          for (const auto& pipe : network.pipes) {
+            effort.segment(res_startIdx, pipe.n_rho) = z.segment(state_startIdx, pipe.n_rho) * pipe.RT;
+            effort.segment(res_startIdx+pipe.n_rho, pipe.n_mom) = z.segment(state_startIdx+pipe.n_rho, pipe.n_mom);
+            state_startIdx += pipe.n_state;
+            res_startIdx += pipe.n_res;
+          }
+
+          r = network.E * dz_dt - network.J * effort - network.J_ref;
+
+          // Hyper-reduced friction, evaluated only at the DEIM nodes
+          state_startIdx = 0, res_startIdx = 0;
+          for (const auto& pipe : network.pipes) {
+            Eigen::Vector<T, Eigen::Dynamic> rho = pipe.V_rho_sampled * z.segment(state_startIdx, pipe.n_rho) + pipe.rho_ref_sampled;
+            Eigen::Vector<T, Eigen::Dynamic> mom = pipe.V_mom_sampled * z.segment(state_startIdx+pipe.n_rho, pipe.n_mom) + pipe.mom_ref_sampled;
+            Eigen::Vector<T, Eigen::Dynamic> friction_term(rho.size());
+            for (int i = 0; i < rho.size(); ++i)
+              friction_term(i) = ceres::abs(pipe.friction * mom(i)/rho(i) / (2 * pipe.diameter)) * mom(i);
+
+            r.segment(res_startIdx+pipe.n_rho, pipe.n_mom) += pipe.deim_projector * friction_term;
+            state_startIdx += pipe.n_state;
+            res_startIdx += pipe.n_res;
+          }
+
+          // Boundary and compressor coupling rows, see DiscreteNetwork::set_state
+          r(network.pipes[0].n_state) -= T(input_vec(0));
+
+          state_startIdx = 0, res_startIdx = 0;
+          for (int k = 0; k < network.compressors.size(); ++k) {
+            const auto& upstream   = network.pipes[k];
+            const auto& downstream = network.pipes[k+1];
+            const auto& compressor = network.compressors[k];
+            const int downstream_state_startIdx = state_startIdx + upstream.n_state;
+            const int downstream_res_startIdx   = res_startIdx + upstream.n_res;
+            const int n_rho_upstream = upstream.V_rho.rows();
+
+            T precompressor_pressure = upstream.RT * (
+              (upstream.V_rho.row(n_rho_upstream-1) * z.segment(state_startIdx, upstream.n_rho)).value() + upstream.rho_ref(n_rho_upstream-1)
+            );
+            T postcompressor_momentum = (
+              (downstream.V_mom.row(0) * z.segment(downstream_state_startIdx+downstream.n_rho, downstream.n_mom)).value() + downstream.mom_ref(0)
+            );
+
+            T outlet_coupling = -postcompressor_momentum;
+            T inlet_coupling = T(1.0);
+            if (compressor.type == "FC") {
+              inlet_coupling = precompressor_pressure;
+            }
+            else if (compressor.type == "FP" && compressor.model == "AV") {
+              outlet_coupling *= ceres::pow(precompressor_pressure, 1.0/compressor.isentropic_exponent);
+            }
+
+            r(res_startIdx+upstream.n_state+1)            -= outlet_coupling * input_vec(2*k+1);
+            r(downstream_res_startIdx+downstream.n_state) -= inlet_coupling * input_vec(2*k+2);
+
+            state_startIdx = downstream_state_startIdx;
+            res_startIdx   = downstream_res_startIdx;
+          }
+
+          r(res_startIdx+network.pipes.back().n_state+1) -= T(input_vec(input_vec.size()-1));
+
+          return true;
+      }
+
+      private:
+          const ReducedNetwork& network;
+          Eigen::Ref<const Eigen::VectorXd> current_state;
+          Eigen::Ref<const Eigen::VectorXd> input_vec;
+          const double timestep;
+  };
+
+}
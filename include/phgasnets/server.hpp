@@ -0,0 +1,99 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# pragma once
+
+# include "simulator.hpp"
+# include "io.hpp"
+
+# include <functional>
+# include <string>
+# include <vector>
+# include <nlohmann/json.hpp>
+
+namespace phgasnets {
+
+  /**
+   * A boundary value over time, either constant or piecewise linear in [[time, value], ...] pairs,
+   * held constant beyond the first and last time.
+   */
+  struct BoundaryProfile {
+      BoundaryProfile(const double value);
+      BoundaryProfile(const nlohmann::json& profile);
+
+      double operator()(const double time) const;
+
+      private:
+        std::vector<double> times, values;
+  };
+
+  /**
+   * Runs a what-if scenario from a resident simulator, starting over from a baseline state.
+   *
+   * The request may hold
+   *   "horizon"         simulated time [s] after the baseline time (required)
+   *   "step"            time step size [s], the configured one by default
+   *   "inlet_pressure"  BoundaryProfile of the inlet pressure [Pa], relative to the baseline time
+   *   "outlet_momentum" BoundaryProfile of the outlet momentum, relative to the baseline time
+   *   "specification"   compressor setpoint (compression ratio or outlet pressure)
+   *   "probes"          list of probe locations, as for probesFromJson
+   *   "frequency"       keep every frequency-th time step of the probe series
+   * Boundaries not given keep their baseline values.
+   *
+   * The compressor setpoint enters through the boundary input only, the outlet temperature
+   * of the compressor remains as discretized.
+   *
+   * @param simulator the simulator, reset to the baseline on every call
+   * @param baseline the baseline state, e.g. the steady state
+   * @param request the scenario request
+   *
+   * @return {"time": [...], "probes": {name: {"pressure": [...], "momentum": [...]}}, "iterations": ..., "converged": ...}
+   *
+   * @throws std::invalid_argument if the request lacks a horizon or has a non-positive step size
+   */
+  nlohmann::json runScenario(
+      Simulator& simulator,
+      const Checkpoint& baseline,
+      const nlohmann::json& request
+  );
+
+  /**
+   * Serves requests over a Unix domain socket, one JSON object per line.
+   *
+   * Connections are served one after another, each answered line by line with the handler result.
+   * A handler exception is answered with {"status": "error", "message": ...}, and the request
+   * {"command": "shutdown"} stops the server.
+   */
+  struct SimulationServer {
+      using Handler = std::function<nlohmann::json(const nlohmann::json&)>;
+
+      /**
+       * Binds and listens on the socket path, replacing a stale socket file.
+       *
+       * @throws std::runtime_error if the socket cannot be created or bound
+       */
+      SimulationServer(const std::string& socket_path, Handler handler);
+      ~SimulationServer();
+
+      SimulationServer(const SimulationServer&) = delete;
+      SimulationServer& operator=(const SimulationServer&) = delete;
+
+      /**
+       * Serves connections until a shutdown request arrives.
+       */
+      void run();
+
+      public:
+        const std::string socket_path;
+
+      private:
+        bool serve(const int connection);
+
+        Handler handler;
+        int listener;
+  };
+
+}
@@ -0,0 +1,226 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# pragma once
+
+# include "network.hpp"
+# include "io.hpp"
+# include "footprint.hpp"
+# include "trace.hpp"
+
+# include <functional>
+# include <memory>
+# include <string>
+# include <Eigen/Core>
+# include <nlohmann/json.hpp>
+# include <ceres/ceres.h>
+
+namespace phgasnets {
+
+  struct TransientCompressorSystem;
+
+  /**
+   * Differentiation of the residual for the Jacobian of the nonlinear solves.
+   */
+  enum class Differentiation {
+    Automatic,          // dual numbers (ceres::Jet), exact up to round-off
+    ForwardDifference,  // one residual evaluation per state entry
+    CentralDifference   // two residual evaluations per state entry, more accurate
+  };
+
+  /**
+   * Parses "automatic", "forward" or "central".
+   *
+   * @throws std::invalid_argument for any other name
+   */
+  Differentiation differentiationFromString(const std::string& name);
+
+  /**
+   * Name of the differentiation, as accepted by differentiationFromString.
+   */
+  std::string to_string(const Differentiation differentiation);
+
+  /**
+   * Differentiation given by the optional "differentiation" entry of the discretization
+   * parameters, otherwise automatic, or central if built with -DPHGASNETS_NUMERICDIFF=ON.
+   *
+   * @throws std::invalid_argument for an unknown differentiation
+   */
+  Differentiation differentiationFromJson(const nlohmann::json& disc_params);
+
+  /**
+   * Records each evaluation of a cost function as a trace event, named by whether Jacobians
+   * were requested, such that finite-difference evaluations are labeled as those of automatic
+   * differentiation. Takes ownership of the cost function.
+   */
+  struct TracedCostFunction : ceres::DynamicCostFunction {
+      TracedCostFunction(
+          ceres::DynamicCostFunction* cost_function,
+          const char* residual_name,
+          const char* jacobian_name
+      ) : cost_function(cost_function), residual_name(residual_name), jacobian_name(jacobian_name)
+      {}
+
+      void AddParameterBlock(int size) override {
+        cost_function->AddParameterBlock(size);
+        ceres::DynamicCostFunction::AddParameterBlock(size);
+      }
+
+      void SetNumResiduals(int num_residuals) override {
+        cost_function->SetNumResiduals(num_residuals);
+        ceres::DynamicCostFunction::SetNumResiduals(num_residuals);
+      }
+
+      bool Evaluate(double const* const* parameters, double* residuals, double** jacobians) const override {
+        PHGASNETS_TRACE_SCOPE(jacobians ? jacobian_name : residual_name);
+        return cost_function->Evaluate(parameters, residuals, jacobians);
+      }
+
+      private:
+        std::unique_ptr<ceres::DynamicCostFunction> cost_function;
+        const char* residual_name;
+        const char* jacobian_name;
+  };
+
+  /**
+   * Wraps a residual functor into a cost function of the given differentiation,
+   * taking ownership of the functor. Evaluations are traced under the given names,
+   * which must outlive the trace, e.g. literals.
+   */
+  template<typename Functor>
+  ceres::DynamicCostFunction* differentiate(
+      Functor* functor,
+      const Differentiation differentiation,
+      const char* residual_name = "residual",
+      const char* jacobian_name = "jacobian"
+  ) {
+    ceres::DynamicCostFunction* cost_function;
+    switch (differentiation) {
+      case Differentiation::ForwardDifference:
+        cost_function = new ceres::DynamicNumericDiffCostFunction<Functor, ceres::FORWARD>(functor);
+        break;
+      case Differentiation::CentralDifference:
+        cost_function = new ceres::DynamicNumericDiffCostFunction<Functor, ceres::CENTRAL>(functor);
+        break;
+      default:
+        cost_function = new ceres::DynamicAutoDiffCostFunction<Functor>(functor);
+    }
+    return new TracedCostFunction(cost_function, residual_name, jacobian_name);
+  }
+
+  /**
+   * Transient simulation of a compressor network, owning the discretized network,
+   * the solver state and the Ceres problem.
+   *
+   * All buffers are allocated on construction, such that repeated calls to step()
+   * do not reallocate. The network and discretization parameters must outlive the simulator.
+   */
+  struct Simulator {
+      /**
+       * Differentiates as given by differentiationFromJson(disc_params).
+       */
+      Simulator(
+          const Network& network,
+          const nlohmann::json& disc_params
+      );
+
+      Simulator(
+          const Network& network,
+          const nlohmann::json& disc_params,
+          const Differentiation differentiation
+      );
+
+      Simulator(const Simulator&) = delete;
+      Simulator& operator=(const Simulator&) = delete;
+
+      /**
+       * Solves for the steady state at the current input and sets it as the current state.
+       *
+       * @param initial_guess initial guess of the steady state
+       *
+       * @return summary of the steady solve
+       */
+      const ceres::Solver::Summary& initialize(const Eigen::Ref<const Eigen::VectorXd>& initial_guess);
+
+      /**
+       * Resumes from a checkpoint without solving for the steady state.
+       *
+       * @param checkpoint the checkpoint to resume from
+       *
+       * @throws std::invalid_argument if the checkpoint is of another network or discretization,
+       *         or its state or input do not match in size
+       */
+      void initialize(const Checkpoint& checkpoint);
+
+      /**
+       * Sets the current state without any solve, e.g. from a cached steady state.
+       *
+       * @param state the new current state
+       *
+       * @throws std::invalid_argument if the state does not match the network in size
+       */
+      void set_state(const Eigen::Ref<const Eigen::VectorXd>& state);
+
+      /**
+       * Advances the current state by one implicit midpoint step.
+       *
+       * @param dt the time step size [s]
+       *
+       * @return summary of the solve
+       */
+      const ceres::Solver::Summary& step(const double dt);
+
+      /**
+       * Advances the current state up to the given time with the configured step size.
+       *
+       * @param end_time the time to advance to [s]
+       */
+      void advance_to(const double end_time);
+
+      /**
+       * Creates a checkpoint of the current simulation state.
+       */
+      Checkpoint checkpoint() const;
+
+      /**
+       * Memory held by the discrete network, the discretizations of the transient residual
+       * (the Jet one is built by the first Jacobian evaluation) and the solver state.
+       * The dense Jacobian is allocated by Ceres, its size is an estimate.
+       */
+      MemoryFootprint footprint() const;
+
+      // Accessors
+      double time() const { return current_time; }
+      int step_count() const { return current_step; }
+      const Eigen::VectorXd& state() const { return current_state; }
+      const DiscreteNetwork<double>& discrete_network() const { return network; }
+      Differentiation differentiation() const { return differentiation_mode; }
+      Eigen::Vector4d& input() { return input_vec; }
+      const Eigen::Vector4d& input() const { return input_vec; }
+
+      public:
+        // Called before each step with the time at the end of the step,
+        // to update the boundary input and the initial guess of the solve.
+        std::function<void(double time, double dt, Eigen::Vector4d& input_vec, Eigen::VectorXd& guess)> boundary_update;
+
+        ceres::Solver::Options options;
+        ceres::Solver::Summary summary;
+
+      private:
+        const Network& net;
+        const nlohmann::json& disc_params;
+        const Differentiation differentiation_mode;
+        DiscreteNetwork<double> network;
+        Eigen::VectorXd current_state, guess;
+        Eigen::Vector4d input_vec;
+        double current_time, timestep;
+        const double default_timestep;
+        int current_step;
+        ceres::Problem problem;
+        const TransientCompressorSystem* transient_system;  // owned by the problem
+  };
+
+}
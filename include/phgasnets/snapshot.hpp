@@ -0,0 +1,84 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# pragma once
+
+# include "network.hpp"
+
+# include <memory>
+# include <string>
+# include <vector>
+# include <nlohmann/json.hpp>
+
+namespace phgasnets {
+
+  /**
+   * Writes a binary snapshot of a discretized network.
+   *
+   * The snapshot holds the network hash, the gas constant, the spatial discretization parameters,
+   * the pipe and compressor parameters, and the static operators Et and Jt of every pipe
+   * in compressed column form.
+   *
+   * @param filename the snapshot file
+   * @param network the network of pipes and compressors
+   * @param spatial_disc_params the spatial discretization parameters
+   *
+   * @throws std::runtime_error if the file cannot be written
+   */
+  void writeNetworkSnapshot(
+      const std::string& filename,
+      const Network& network,
+      const nlohmann::json& spatial_disc_params
+  );
+
+  /**
+   * A network snapshot, memory-mapped read-only.
+   *
+   * Pipes and compressors are restored without parsing a configuration file. Networks given
+   * the snapshot operators are discretized without assembling Et and Jt from triplets,
+   * the pipes adopt them straight from the mapping, which stays alive as long as any network
+   * holds the operators.
+   */
+  struct NetworkSnapshot {
+      /**
+       * @param filename the snapshot file
+       *
+       * @throws std::runtime_error if the file cannot be mapped or is not a complete snapshot
+       */
+      NetworkSnapshot(const std::string& filename);
+
+      NetworkSnapshot(const NetworkSnapshot&) = delete;
+      NetworkSnapshot& operator=(const NetworkSnapshot&) = delete;
+
+      /**
+       * Network over the stored pipes and compressors with the snapshot operators.
+       * The fluid must be the one the snapshot was written with, the ideal gas of the
+       * stored gas constant by default. The snapshot must outlive the network.
+       *
+       * @throws std::invalid_argument if the snapshot was written for another fluid
+       */
+      Network network();
+      Network network(const Fluid& fluid);
+
+      /**
+       * Gives a network the snapshot operators, such that it is discretized without assembling them.
+       *
+       * @param network a network equal to the one of the snapshot
+       *
+       * @throws std::invalid_argument if the network hash differs from the one of the snapshot
+       */
+      void adoptOperators(Network& network) const;
+
+      public:
+        std::string hash;
+        double gas_constant;
+        nlohmann::json spatial_disc_params;
+        std::vector<Pipe> pipes;
+        std::vector<Compressor> compressors;
+        std::shared_ptr<const StaticOperators> operators;
+  };
+
+}
@@ -10,12 +10,15 @@
 # include "pipe.hpp"
 # include "compressor.hpp"
 # include "network.hpp"
+# include "fluid.hpp"
 # include "utils.hpp"
 
+# include <stdexcept>
 # include <Eigen/SparseCore>
 # include <nlohmann/json.hpp>
 
 namespace phgasnets {
+    // Steady state of a single pipe of an ideal gas, whose pressure factor RT is folded from the fluid
     struct SteadySystem{
         SteadySystem(
             const int n_rho, const int n_mom,
@@ -24,9 +27,14 @@ namespace phgasnets {
             const double& friction,
             const double& diameter,
             const double& temperature,
+            const Fluid& fluid,
             const Eigen::Vector2d& input_vec
-        ): n_rho(n_rho), n_mom(n_mom), Jt(Jt), G(G), input_vec(input_vec), f(friction), D(diameter), temperature(temperature)
-        {}
+        ): n_rho(n_rho), n_mom(n_mom), Jt(Jt), G(G), input_vec(input_vec), f(friction), D(diameter), temperature(temperature),
+           RT(fluid.RT(temperature))
+        {
+            if (!fluid.ideal())
+              throw std::invalid_argument("A single pipe system requires an ideal gas.");
+        }
 
         template <typename T>
         bool operator()(T const* const* guess_state, T* residual) const {
@@ -38,7 +46,8 @@ namespace phgasnets {
 
             // build necessary objects for non-linear eq
             static auto Rt = Rt_operator<T>(n_rho, n_mom, f, D);
-            static auto effort = effortVec<T>(n_rho, n_mom, temperature);
+            static auto effort = effortVec<T>(n_rho, n_mom, RT);
+            effort.RT = RT;
             effort.update_state(rho, mom);
             Rt.update_state(rho, mom);
 
@@ -54,6 +63,7 @@ namespace phgasnets {
             const double f;
             const double D;
             const double temperature;
+            const double RT;
             const Jt_operator& Jt;
             const G_operator<double>& G;
             const Eigen::Vector2d& input_vec;
@@ -63,8 +73,9 @@ namespace phgasnets {
         SteadyCompressorSystem(
             const Network& network,
             const nlohmann::json& spatial_disc_params,
-            const Eigen::Vector4d& input_vec
-        ) : network(network), spatial_disc_params(spatial_disc_params), input_vec(input_vec)
+            const Eigen::Ref<const Eigen::VectorXd>& input_vec
+        ) : network(network), spatial_disc_params(spatial_disc_params), input_vec(input_vec),
+            discrete_networks(network, spatial_disc_params)
         {}
 
         template <typename T>
@@ -72,27 +83,30 @@ namespace phgasnets {
             T const* const* guess_state,
             T* residual
         ) const {
-
-            static auto discrete_network = discretize<T>(network, spatial_disc_params);
+            auto& discrete_network = discrete_networks.get<T>();
 
             Eigen::Map<const Eigen::Vector<T, Eigen::Dynamic>> z(guess_state[0], discrete_network.n_state);
             Eigen::Map<Eigen::Vector<T, Eigen::Dynamic>> r(residual, discrete_network.n_res);
 
             discrete_network.set_state(z);
 
-            // solve non-linear eq and populate residual with result
-            r = (
-                discrete_network.J * discrete_network.effort
-                - discrete_network.R * discrete_network.effort
-                + discrete_network.G * input_vec
-            );
+            // solve non-linear eq and populate residual with result, without temporaries
+            r.noalias() = discrete_network.J * discrete_network.effort;
+            r.noalias() -= discrete_network.R * discrete_network.effort;
+            r.noalias() += discrete_network.G * input_vec;
 
             return true;
         }
 
+        // Memory held by the discretizations of this residual, per scalar type
+        MemoryFootprint footprint() const {
+            return discrete_networks.footprint();
+        }
+
         private:
             const Network& network;
             const nlohmann::json& spatial_disc_params;
-            const Eigen::Vector4d& input_vec;
+            Eigen::Ref<const Eigen::VectorXd> input_vec;
+            mutable DiscreteNetworkCache discrete_networks;
     };
 }
@@ -0,0 +1,90 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# pragma once
+
+# include "network.hpp"
+
+# include <string>
+# include <vector>
+# include <Eigen/Core>
+# include <nlohmann/json.hpp>
+
+namespace phgasnets {
+
+  /**
+   * A discretization setting of a sweep.
+   */
+  struct SweepPoint {
+      int resolution;    // number of cells per pipe
+      double timestep;   // time step size [s]
+  };
+
+  /**
+   * Cost and accuracy of a scenario at one discretization setting.
+   */
+  struct SweepResult {
+      int resolution;
+      double timestep;
+      double runtime;          // CPU time of the transient run, without the steady state [s]
+      int iterations;          // total solver iterations
+      std::string steady_termination; // termination type of the steady state solve, e.g. CONVERGENCE
+      bool converged;          // whether the steady state and every step converged
+      double pressure_error;   // largest deviation of the outlet pressure, relative to the largest reference pressure
+      double momentum_error;   // largest deviation of the outlet momentum, relative to the largest reference momentum
+      bool pareto;             // no other converged setting is both faster and more accurate
+
+      nlohmann::json to_json() const;
+  };
+
+  /**
+   * Constant initial guess of the steady state of a compressor chain, at the inlet pressure
+   * scaled by the compression ratios and the outlet momentum scaled back by the momentum scales.
+   *
+   * @param network the network
+   * @param resolution number of cells per pipe
+   * @param inlet_pressure the inlet pressure [Pa]
+   * @param outlet_momentum the outlet momentum
+   */
+  Eigen::VectorXd steadyStateGuess(
+      const Network& network,
+      const int resolution,
+      const double inlet_pressure,
+      const double outlet_momentum
+  );
+
+  /**
+   * Runs a scenario at every setting of a grid and at a fine reference setting,
+   * and compares the outlet pressure and momentum of the last pipe to the reference.
+   *
+   * Every run solves for its own steady state from the given input, then runs the scenario
+   * with runScenario. Deviations are taken at the time steps of each run, with the reference
+   * interpolated linearly in time. Settings whose steady state does not converge are run
+   * nonetheless, but marked as not converged and left out of the Pareto front.
+   *
+   * @param network the network
+   * @param disc_params discretization parameters, whose resolution and step are overridden
+   * @param input boundary input of the steady state
+   * @param scenario scenario request as for runScenario, without step and probes
+   * @param grid the settings to compare
+   * @param reference the setting of the reference solution, finer than any in the grid
+   * @param threads number of settings run in parallel
+   *
+   * @return the results in the order of the grid
+   *
+   * @throws std::runtime_error if the steady state or the scenario of the reference run does not converge
+   */
+  std::vector<SweepResult> sweepDiscretizations(
+      const Network& network,
+      const nlohmann::json& disc_params,
+      const Eigen::Vector4d& input,
+      const nlohmann::json& scenario,
+      const std::vector<SweepPoint>& grid,
+      const SweepPoint& reference,
+      const int threads = 1
+  );
+
+}
@@ -0,0 +1,103 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# pragma once
+
+# include "output.hpp"
+
+# include <fstream>
+# include <string>
+# include <ceres/ceres.h>
+# include <nlohmann/json.hpp>
+
+namespace phgasnets {
+
+  /**
+   * Solver cost of a single time step, taken from the ceres summary of its solve.
+   */
+  struct StepTelemetry {
+      int step;
+      double time;                  // simulation time at the end of the step [s]
+      double dt;                    // time step size [s]
+      int iterations;
+      int residual_evaluations;
+      int jacobian_evaluations;
+      double solver_time;           // total wall time of the solve [s]
+      double residual_time;         // wall time spent in residual evaluations [s]
+      double jacobian_time;         // wall time spent in Jacobian evaluations [s]
+      double linear_solver_time;    // wall time spent in linear solves [s]
+      double io_wait_time;          // wall time the time loop spent on outputs of the step, excluding background writes [s]
+      double final_cost;
+      std::string termination;
+
+      nlohmann::json to_json() const;
+  };
+
+  /**
+   * Collects per-step solver telemetry and writes it as JSON lines, one object per step.
+   *
+   * Aggregates over all steps are kept in memory, in particular the most expensive steps,
+   * e.g. those following a jump in the boundary conditions.
+   */
+  struct SolverTelemetry {
+      /**
+       * @param filename JSON lines file to write to, nothing is written if empty
+       * @param append append to an existing file, e.g. on restart
+       *
+       * @throws std::runtime_error if the file cannot be opened
+       */
+      SolverTelemetry(const std::string& filename = "", const bool append = false);
+
+      /**
+       * Records the solve of a time step.
+       *
+       * @param step the time step index
+       * @param time simulation time at the end of the step [s]
+       * @param dt the time step size [s]
+       * @param summary the summary of the solve
+       * @param io_wait_time wall time the time loop spent on outputs of the step [s]
+       */
+      const StepTelemetry& record(
+          const int step,
+          const double time,
+          const double dt,
+          const ceres::Solver::Summary& summary,
+          const double io_wait_time = 0.0
+      );
+
+      /**
+       * Removes the records of steps after the given one from an appended file, e.g. those
+       * computed after the checkpoint a run restarts from. Unreadable lines are removed as well.
+       *
+       * @param step the last time step index to keep
+       *
+       * @throws std::runtime_error if the file cannot be rewritten
+       */
+      void discardAfter(const int step);
+
+      /**
+       * Totals, iteration statistics, non-converged steps and the steps with the most iterations.
+       *
+       * @param n_slowest number of most expensive steps to report, at most 32 are kept
+       */
+      nlohmann::json to_json(const std::size_t n_slowest = 10) const;
+
+      public:
+        RunningStatistics iterations;
+        double solver_time = 0.0, residual_time = 0.0, jacobian_time = 0.0;
+        double linear_solver_time = 0.0, io_wait_time = 0.0;
+        long residual_evaluations = 0, jacobian_evaluations = 0;
+        std::vector<int> unconverged_steps;
+
+      private:
+        std::string filename;
+        std::ofstream file;
+        std::vector<StepTelemetry> slowest;   // sorted by descending iterations, then solver time
+        std::size_t max_slowest = 32;
+        StepTelemetry last;
+  };
+
+}
@@ -0,0 +1,71 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# pragma once
+
+# include <chrono>
+# include <string>
+
+// Scoped tracing is compiled in with -DPHGASNETS_TRACING=ON only, and expands to nothing otherwise
+# ifndef PHGASNETS_TRACING
+#   define PHGASNETS_TRACING 0
+# endif
+
+# define PHGASNETS_TRACE_CONCAT_(a, b) a##b
+# define PHGASNETS_TRACE_CONCAT(a, b) PHGASNETS_TRACE_CONCAT_(a, b)
+
+# if PHGASNETS_TRACING
+    // Records the enclosing scope as a trace event, the name must outlive the trace, e.g. a literal
+#   define PHGASNETS_TRACE_SCOPE(name) \
+      const ::phgasnets::TraceScope PHGASNETS_TRACE_CONCAT(phgasnets_trace_scope_, __LINE__)(name)
+# else
+#   define PHGASNETS_TRACE_SCOPE(name) do {} while (false)
+# endif
+
+namespace phgasnets {
+
+  /**
+   * Starts recording trace events of all threads.
+   *
+   * Events are kept in memory per thread until stopTracing() writes them.
+   */
+  void startTracing();
+
+  /**
+   * Stops recording and writes the events as Chrome trace-event JSON, viewable in Perfetto
+   * or chrome://tracing. Background threads, e.g. of AsyncNetworkStateWriter, should be flushed first.
+   *
+   * @param filename the trace file
+   *
+   * @throws std::runtime_error if the file cannot be written
+   */
+  void stopTracing(const std::string& filename);
+
+  /**
+   * Whether events are being recorded.
+   */
+  bool tracing();
+
+  /**
+   * Records its lifetime as a complete trace event, if tracing.
+   */
+  struct TraceScope {
+      explicit TraceScope(const char* name) :
+        name(tracing() ? name : nullptr),
+        start(this->name ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point())
+      {}
+
+      ~TraceScope();
+
+      TraceScope(const TraceScope&) = delete;
+      TraceScope& operator=(const TraceScope&) = delete;
+
+      private:
+        const char* name;
+        const std::chrono::steady_clock::time_point start;
+  };
+
+}
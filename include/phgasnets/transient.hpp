@@ -8,12 +8,15 @@
 
 # include "operators.hpp"
 # include "network.hpp"
+# include "fluid.hpp"
 # include "utils.hpp"
 
+# include <stdexcept>
 # include <Eigen/SparseCore>
 # include <nlohmann/json.hpp>
 
 namespace phgasnets {
+    // Transient of a single pipe of an ideal gas, whose pressure factor RT is folded from the fluid
     struct TransientSystem{
         TransientSystem(
             const int n_rho, const int n_mom,
@@ -24,6 +27,7 @@ namespace phgasnets {
             const double& friction,
             const double& diameter,
             const double& temperature,
+            const Fluid& fluid,
             const Eigen::Ref<const Eigen::Vector2d>& input_vec,
             const double& time,
             const double& timestep
@@ -31,9 +35,12 @@ namespace phgasnets {
             n_rho(n_rho), n_mom(n_mom),
             current_state(current_state),
             Et(Et), Jt(Jt), G(G), input_vec(input_vec),
-            f(friction), D(diameter), temperature(temperature),
+            f(friction), D(diameter), temperature(temperature), RT(fluid.RT(temperature)),
             time(time), timestep(timestep)
-        {}
+        {
+            if (!fluid.ideal())
+              throw std::invalid_argument("A single pipe system requires an ideal gas.");
+        }
 
         template <typename T>
         bool operator()(T const* const* guess_state, T* residual) const {
@@ -50,8 +57,9 @@ namespace phgasnets {
 
             // build necessary objects for non-linear eq
             static auto Rt = Rt_operator<T>(n_rho, n_mom, f, D);
-            static auto effort = effortVec<T>(n_rho, n_mom, temperature);
+            static auto effort = effortVec<T>(n_rho, n_mom, RT);
             // Update effort and Rt_mat
+            effort.RT = RT;
             effort.update_state(rho, mom);
             Rt.update_state(rho, mom);
 
@@ -70,6 +78,7 @@ namespace phgasnets {
             const double& f;
             const double& D;
             const double& temperature;
+            const double RT;
             Eigen::Ref<const Eigen::Vector2d> input_vec;
             const double& time;
             const double& timestep;
@@ -80,11 +89,28 @@ namespace phgasnets {
             const Network& network,
             const nlohmann::json& disc_params,
             const Eigen::Ref<const Eigen::VectorXd>& current_state,
-            const Eigen::Ref<const Eigen::Vector4d>& input_vec,
+            const Eigen::Ref<const Eigen::VectorXd>& input_vec,
             const double time
         ):
             network(network), current_state(current_state), disc_params(disc_params),
-            input_vec(input_vec), time(time), timestep(disc_params["time"]["step"])
+            input_vec(input_vec), configured_time(time), time(configured_time),
+            configured_timestep(disc_params["time"]["step"]), timestep(configured_timestep),
+            discrete_networks(network, disc_params["space"])
+        {}
+
+        // Time and time step size are bound by reference, such that they may change between solves
+        TransientCompressorSystem(
+            const Network& network,
+            const nlohmann::json& disc_params,
+            const Eigen::Ref<const Eigen::VectorXd>& current_state,
+            const Eigen::Ref<const Eigen::VectorXd>& input_vec,
+            const double& time,
+            const double& timestep
+        ):
+            network(network), current_state(current_state), disc_params(disc_params),
+            input_vec(input_vec), configured_time(time), time(time),
+            configured_timestep(timestep), timestep(timestep),
+            discrete_networks(network, disc_params["space"])
         {}
 
         template <typename T>
@@ -92,33 +118,42 @@ namespace phgasnets {
             T const* const* guess_state,
             T* residual
         ) const {
-            static auto discrete_network = discretize<T>(network, disc_params["space"]);
+            auto& discrete_network = discrete_networks.get<T>();
 
             Eigen::Map<const Eigen::Vector<T, Eigen::Dynamic>> new_state(guess_state[0], discrete_network.n_state);
             Eigen::Map<Eigen::Vector<T, Eigen::Dynamic>> r(residual, discrete_network.n_res);
 
-            // Implicit midpoint rule
-            auto z = (new_state + current_state) * 0.5;
-            auto dz_dt = (new_state - current_state) / timestep;
+            // Implicit midpoint rule, evaluated into preallocated workspaces
+            auto& z = discrete_network.midpoint;
+            auto& dz_dt = discrete_network.rate;
+            z = (new_state + current_state) * 0.5;
+            dz_dt = (new_state - current_state) / timestep;
 
             discrete_network.set_state(z);
 
-            r = (
-                discrete_network.E * dz_dt
-                - discrete_network.J * discrete_network.effort
-                + discrete_network.R * discrete_network.effort
-                - discrete_network.G * input_vec
-            );
+            // Accumulate sparse products directly into the residual, without temporaries
+            r.noalias() = discrete_network.E * dz_dt;
+            r.noalias() -= discrete_network.J * discrete_network.effort;
+            r.noalias() += discrete_network.R * discrete_network.effort;
+            r.noalias() -= discrete_network.G * input_vec;
 
             return true;
         }
 
+        // Memory held by the discretizations of this residual, per scalar type
+        MemoryFootprint footprint() const {
+            return discrete_networks.footprint();
+        }
+
         private:
             const Network& network;
             const nlohmann::json& disc_params;
             Eigen::Ref<const Eigen::VectorXd> current_state;
-            Eigen::Ref<const Eigen::Vector4d> input_vec;
+            Eigen::Ref<const Eigen::VectorXd> input_vec;
+            const double configured_time;
             const double& time;
-            const double timestep;
+            const double configured_timestep;
+            const double& timestep;
+            mutable DiscreteNetworkCache discrete_networks;
     };
 }
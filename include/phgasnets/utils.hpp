@@ -8,6 +8,9 @@
 
 # include "operators.hpp"
 
+# include <fstream>
+# include <initializer_list>
+# include <string>
 # include <vector>
 # include <Eigen/Core>
 # include <Eigen/SparseCore>
@@ -48,7 +51,8 @@ Eigen::SparseMatrix<T> diagonalBlock(
     }
 
     // Add the first operator
-    std::vector<Eigen::Triplet<T>> data(nnz);
+    std::vector<Eigen::Triplet<T>> data;
+    data.reserve(nnz);
     data.insert(data.end(), operators[0].get().data.begin(), operators[0].get().data.end());
     // Iteratively include data from rest of the operators taking care of row/column offset
     int startRow = operators[0].get().mat.rows();
@@ -66,6 +70,43 @@ Eigen::SparseMatrix<T> diagonalBlock(
     return mat;
 }
 
+/**
+ * Creates a diagonal block sparse matrix from sparse matrices, by appending their columns
+ * in order without triplets, such that matrices adopted without a triplet list can be blocked.
+ *
+ * @param matrices a vector of references to column-major sparse matrices
+ *
+ * @return a sparse matrix with diagonal blocks formed from the matrices
+ *
+ * @throws None
+ */
+template <typename T>
+Eigen::SparseMatrix<T> diagonalBlock(
+    const std::vector<std::reference_wrapper<const Eigen::SparseMatrix<T>>>& matrices
+){
+    int nnz = 0, n_rows = 0, n_cols = 0;
+    for (const auto& matrix : matrices) {
+        nnz += matrix.get().nonZeros();
+        n_rows += matrix.get().rows();
+        n_cols += matrix.get().cols();
+    }
+
+    Eigen::SparseMatrix<T> mat(n_rows, n_cols);
+    mat.reserve(nnz);
+    int startRow = 0, startCol = 0;
+    for (const auto& matrix : matrices) {
+        for (int j = 0; j < matrix.get().outerSize(); ++j) {
+            mat.startVec(startCol + j);
+            for (typename Eigen::SparseMatrix<T>::InnerIterator it(matrix.get(), j); it; ++it)
+                mat.insertBack(startRow + it.row(), startCol + j) = it.value();
+        }
+        startRow += matrix.get().rows();
+        startCol += matrix.get().cols();
+    }
+    mat.finalize();
+    return mat;
+}
+
 /*
  * Writes a vector of vectors of doubles to a CSV file.
  *
@@ -81,4 +122,61 @@ void writeColumnsToCSV(
     const std::vector<std::vector<double>>& columns
 );
 
+/*
+ * Streams rows of doubles to a space-delimited CSV file.
+ *
+ * Rows are formatted with std::to_chars into a buffer, which is written out
+ * whenever it is full, such that rows need not be kept in memory.
+ * The format matches writeColumnsToCSV, i.e. scientific with 6 digits.
+ */
+struct CSVWriter {
+    /*
+     * @param filename the name of the file to write to
+     * @param column_names the names of the columns, written as header
+     * @param buffer_size size of the output buffer in bytes
+     *
+     * @throws std::runtime_error if the file cannot be opened
+     */
+    CSVWriter(
+        const std::string& filename,
+        const std::vector<std::string>& column_names,
+        const std::size_t buffer_size = 1 << 20
+    );
+
+    // Flushes the remaining rows, reporting a failed write on stderr
+    ~CSVWriter();
+
+    CSVWriter(const CSVWriter&) = delete;
+    CSVWriter& operator=(const CSVWriter&) = delete;
+
+    /*
+     * Appends a row of num_columns values.
+     *
+     * @throws std::runtime_error if writing out the full buffer fails
+     */
+    void writeRow(const double* values);
+
+    /*
+     * @throws std::invalid_argument if the number of values does not match the columns
+     * @throws std::runtime_error if writing out the full buffer fails
+     */
+    void writeRow(std::initializer_list<double> values);
+
+    /*
+     * Writes out the buffered rows.
+     *
+     * @throws std::runtime_error if the file cannot be written, e.g. on a full disk
+     */
+    void flush();
+
+    public:
+      const std::size_t num_columns;
+      const std::string filename;
+
+    private:
+      std::ofstream file;
+      std::vector<char> buffer;
+      std::size_t used;
+};
+
 }
@@ -0,0 +1,140 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# include "adjoint.hpp"
+# include "simulator.hpp"
+
+# include <stdexcept>
+# include <string>
+# include <Eigen/OrderingMethods>
+# include <Eigen/SparseQR>
+
+namespace phgasnets {
+
+TransientAdjoint::TransientAdjoint(
+  const Network& network,
+  const nlohmann::json& disc_params
+) :
+  network(discretize<double>(network, disc_params["space"])),
+  timestep(disc_params["time"]["step"]),
+  input_vec(Eigen::VectorXd::Zero(2*network.pipes.size()))
+{
+  if (network.pipes.empty() || network.compressors.size() != network.pipes.size()-1)
+    throw std::invalid_argument("The adjoint requires a chain of pipes joined by compressors.");
+  current_state.resize(this->network.n_state);
+
+  // The same residual as the forward solve, bound to the members replayed in the backward sweep
+  auto cost = differentiate(
+    new TransientCompressorSystem(network, disc_params, current_state, input_vec, time, timestep),
+    Differentiation::Automatic, "adjoint_residual", "adjoint_jacobian"
+  );
+  cost->AddParameterBlock(this->network.n_state);
+  cost->SetNumResiduals(this->network.n_res);
+  cost_function.reset(cost);
+}
+
+void TransientAdjoint::record_initial_state(const Eigen::Ref<const Eigen::VectorXd>& state) {
+  states.clear();
+  inputs.clear();
+  states.push_back(state);
+}
+
+void TransientAdjoint::record(
+  const Eigen::Ref<const Eigen::VectorXd>& input_vec,
+  const Eigen::Ref<const Eigen::VectorXd>& state
+) {
+  if (input_vec.size() != this->input_vec.size())
+    throw std::invalid_argument("Expected an input of size " + std::to_string(this->input_vec.size()) + ".");
+  if (state.size() != network.n_state)
+    throw std::invalid_argument("Expected a state of size " + std::to_string(network.n_state) + ".");
+  inputs.push_back(input_vec);
+  states.push_back(state);
+}
+
+AdjointGradient TransientAdjoint::gradient(const std::vector<Eigen::VectorXd>& output_sensitivities) {
+  if (output_sensitivities.size() != states.size())
+    throw std::invalid_argument("Output sensitivities do not match the recorded states.");
+
+  const int n_state = network.n_state;
+  const int n_res   = network.n_res;
+  const int n_steps = inputs.size();
+
+  AdjointGradient grad;
+  grad.inputs.resize(n_steps);
+  grad.friction = Eigen::VectorXd::Zero(network.pipes.size());
+
+  Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> jacobian(n_res, n_state);
+  Eigen::VectorXd residual(n_res), w(n_res), y(n_state);
+  Eigen::SparseQR<Eigen::SparseMatrix<double>, Eigen::COLAMDOrdering<int>> qr;
+
+  // Adjoint of the final state
+  Eigen::VectorXd state_adjoint = output_sensitivities[n_steps];
+
+  for (int n = n_steps-1; n >= 0; --n) {
+    // A = dF/dz_{n+1} at the recorded step
+    current_state = states[n];
+    input_vec     = inputs[n];
+    const double* parameters[] = {states[n+1].data()};
+    double* jacobians[] = {jacobian.data()};
+    cost_function->Evaluate(parameters, residual.data(), jacobians);
+
+    Eigen::SparseMatrix<double> A = jacobian.sparseView();
+    A.makeCompressed();
+
+    // w = A (A^T A)^{-1} lambda from A P = Q R, without squaring the condition of A by the
+    // normal equations, which loses the gradient entirely on stiff steps
+    qr.compute(A);
+    const Eigen::SparseMatrix<double> R = qr.matrixR().topLeftCorner(n_state, n_state);
+    y = qr.colsPermutation().transpose() * state_adjoint;
+    R.transpose().triangularView<Eigen::Lower>().solveInPlace(y);
+    w.setZero();
+    w.head(n_state) = y;
+    w = qr.matrixQ() * w;
+
+    // G(z_mid) and R(z_mid) e(z_mid) at the midpoint
+    network.set_state((states[n+1] + states[n]) * 0.5);
+
+    grad.inputs[n] = network.G.transpose() * w;
+
+    Eigen::VectorXd friction_force = network.R * network.effort;
+    int pipe_res_startIdx = 0;
+    for (int p = 0; p < network.pipes.size(); ++p) {
+      const auto& pipe = network.pipes[p];
+      grad.friction(p) -= w.segment(pipe_res_startIdx, pipe.n_res).dot(
+        friction_force.segment(pipe_res_startIdx, pipe.n_res)
+      ) / pipe.friction;
+      pipe_res_startIdx += pipe.n_res;
+    }
+
+    // B = A - 2E/dt
+    state_adjoint = -(A.transpose() * w) + 2.0/timestep * (network.E.transpose() * w);
+    state_adjoint += output_sensitivities[n];
+  }
+
+  grad.initial_state = state_adjoint;
+
+  return grad;
+}
+
+Eigen::VectorXd pressure_sensitivity(
+  const DiscreteNetwork<double>& network,
+  const int pipe_index,
+  const int node
+) {
+  Eigen::VectorXd w = Eigen::VectorXd::Zero(network.n_state);
+
+  int pipe_state_startIdx = 0;
+  for (int p = 0; p < pipe_index; ++p)
+    pipe_state_startIdx += network.pipes[p].n_state;
+
+  // dp/drho at the current state of the network, RT for the ideal gas
+  const auto& pipe = network.pipes[pipe_index];
+  w(pipe_state_startIdx+node) = pipe.pressure_derivative(pipe.rho(node));
+
+  return w;
+}
+
+}
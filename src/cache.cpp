@@ -0,0 +1,142 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# include "cache.hpp"
+# include "io.hpp"
+
+# include <cmath>
+# include <cstdint>
+# include <cstdio>
+# include <filesystem>
+# include <limits>
+# include <sstream>
+# include <stdexcept>
+# include <string>
+# include <iomanip>
+# include <unistd.h>
+# include <highfive/H5Easy.hpp>
+
+namespace phgasnets {
+
+std::string network_hash(
+  const Network& network,
+  const nlohmann::json& spatial_disc_params
+) {
+  nlohmann::json description;
+  description["gas_constant"] = network.fluid.gas_constant;
+  if (!network.fluid.ideal()) {
+    description["equation_of_state"] = network.fluid.eos->to_json();
+    description["pressure_table"] = {
+      {"min_pressure", network.fluid.table.min_pressure},
+      {"max_pressure", network.fluid.table.max_pressure},
+      {"nodes", network.fluid.table.nodes}
+    };
+  }
+  description["discretization"] = spatial_disc_params;
+  for (const auto& pipe : network.pipes) {
+    description["pipes"].push_back({
+      {"length", pipe.length},
+      {"diameter", pipe.diameter},
+      {"friction", pipe.friction},
+      {"temperature", pipe.temperature}
+    });
+  }
+  for (const auto& compressor : network.compressors) {
+    description["compressors"].push_back({
+      {"type", compressor.type},
+      {"model", compressor.model},
+      {"isentropic_exponent", compressor.isentropic_exponent}
+    });
+  }
+
+  // 64-bit FNV-1a of the canonical (key-sorted) json dump
+  std::uint64_t hash = 14695981039346656037ull;
+  for (const char c : description.dump()) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ull;
+  }
+
+  std::ostringstream hex;
+  hex << std::hex << std::setw(16) << std::setfill('0') << hash;
+  return hex.str();
+}
+
+SteadyStateCache::SteadyStateCache(
+  const std::string& directory,
+  const Network& network,
+  const nlohmann::json& spatial_disc_params
+) :
+  filename(directory + "/steady_" + network_hash(network, spatial_disc_params) + ".h5")
+{
+  std::filesystem::create_directories(directory);
+
+  if (std::filesystem::exists(filename)) {
+    std::lock_guard<std::recursive_mutex> hdf5_lock(hdf5Mutex());
+    H5Easy::File file(filename, H5Easy::File::ReadOnly);
+    operating_points = H5Easy::load<Eigen::MatrixXd>(file, "/operating_points");
+    states           = H5Easy::load<Eigen::MatrixXd>(file, "/states");
+  }
+}
+
+bool SteadyStateCache::lookup(
+  const Eigen::Ref<const Eigen::VectorXd>& operating_point,
+  Eigen::VectorXd& state,
+  double& distance
+) const {
+  if (states.rows() == 0 || operating_points.cols() != operating_point.size())
+    return false;
+
+  // Relative distance, such that pressures and compression ratios weigh alike
+  Eigen::Index nearest = 0;
+  distance = std::numeric_limits<double>::infinity();
+  for (Eigen::Index k = 0; k < operating_points.rows(); ++k) {
+    double d = 0.0;
+    for (Eigen::Index i = 0; i < operating_point.size(); ++i) {
+      const double scale = std::max(std::abs(operating_points(k, i)), 1e-12);
+      d += std::pow((operating_point(i) - operating_points(k, i))/scale, 2);
+    }
+    if (d < distance) {
+      distance = d;
+      nearest = k;
+    }
+  }
+
+  distance = std::sqrt(distance);
+  state = states.row(nearest).transpose();
+  return true;
+}
+
+void SteadyStateCache::store(
+  const Eigen::Ref<const Eigen::VectorXd>& operating_point,
+  const Eigen::Ref<const Eigen::VectorXd>& state
+) {
+  const Eigen::Index k = states.rows();
+  operating_points.conservativeResize(k+1, operating_point.size());
+  states.conservativeResize(k+1, state.size());
+  operating_points.row(k) = operating_point.transpose();
+  states.row(k) = state.transpose();
+
+  // Write aside and rename, such that an interrupted write leaves the previous cache intact.
+  // The temporary file is named by process, such that processes sharing the cache do not
+  // write into each other's file, and lies next to the cache, such that rename stays atomic.
+  std::lock_guard<std::recursive_mutex> hdf5_lock(hdf5Mutex());
+  const std::string tmp_filename = filename + "." + std::to_string(getpid()) + ".tmp";
+  try {
+    H5Easy::File file(tmp_filename, H5Easy::File::Truncate);
+    H5Easy::dump(file, "/operating_points", operating_points);
+    H5Easy::dump(file, "/states", states);
+  }
+  catch (...) {
+    std::remove(tmp_filename.c_str());
+    throw;
+  }
+  if (std::rename(tmp_filename.c_str(), filename.c_str()) != 0) {
+    std::remove(tmp_filename.c_str());
+    throw std::runtime_error("Cannot move steady state cache to " + filename);
+  }
+}
+
+}
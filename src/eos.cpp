@@ -0,0 +1,136 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# include "eos.hpp"
+
+# include <stdexcept>
+# include <string>
+
+namespace phgasnets {
+
+double EquationOfState::density(const double pressure, const double temperature, const double gas_constant) const {
+  return pressure/(compressibility(pressure, temperature)*gas_constant*temperature);
+}
+
+double EquationOfState::pressure(const double density, const double temperature, const double gas_constant) const {
+  const double rhoRT = density*gas_constant*temperature;
+
+  // f(p) = p - Z(p) rho R T, starting from the ideal gas
+  double p = rhoRT;
+  for (int iteration = 0; iteration < 50; ++iteration) {
+    const double f  = p - compressibility(p, temperature)*rhoRT;
+    const double df = 1.0 - compressibility_derivative(p, temperature)*rhoRT;
+    const double dp = f/df;
+    p -= dp;
+    if (std::abs(dp) <= 1e-14*std::abs(p))
+      return p;
+  }
+  throw std::runtime_error("No pressure found for density " + std::to_string(density) + " at temperature " + std::to_string(temperature) + ".");
+}
+
+double IdealGas::compressibility(const double, const double) const {
+  return 1.0;
+}
+
+double IdealGas::compressibility_derivative(const double, const double) const {
+  return 0.0;
+}
+
+nlohmann::json IdealGas::to_json() const {
+  return {{"model", "ideal"}};
+}
+
+PapayGas::PapayGas(const double critical_pressure, const double critical_temperature) :
+  critical_pressure(critical_pressure), critical_temperature(critical_temperature)
+{}
+
+double PapayGas::compressibility(const double pressure, const double temperature) const {
+  const double p_r = pressure/critical_pressure, T_r = temperature/critical_temperature;
+  return 1.0 - 3.52*p_r*std::exp(-2.26*T_r) + 0.274*p_r*p_r*std::exp(-1.878*T_r);
+}
+
+double PapayGas::compressibility_derivative(const double pressure, const double temperature) const {
+  const double p_r = pressure/critical_pressure, T_r = temperature/critical_temperature;
+  return (-3.52*std::exp(-2.26*T_r) + 2*0.274*p_r*std::exp(-1.878*T_r))/critical_pressure;
+}
+
+nlohmann::json PapayGas::to_json() const {
+  return {{"model", "papay"}, {"critical_pressure", critical_pressure}, {"critical_temperature", critical_temperature}};
+}
+
+std::shared_ptr<const EquationOfState> equationOfStateFromJson(const nlohmann::json& params) {
+  const std::string model = params.value("model", "ideal");
+  if (model == "ideal")
+    return std::make_shared<IdealGas>();
+  if (model == "papay")
+    return std::make_shared<PapayGas>(params.value("critical_pressure", 4.6e6), params.value("critical_temperature", 190.6));
+  throw std::invalid_argument("Unknown equation of state " + model + ", expected ideal or papay.");
+}
+
+PressureTable::PressureTable(
+  std::shared_ptr<const EquationOfState> eos,
+  const double gas_constant,
+  const double temperature,
+  const TableRange& range
+) :
+  eos(eos), gas_constant(gas_constant), temperature(temperature),
+  n_intervals(std::max(range.nodes, 2)-1)
+{
+  min_density = eos->density(range.min_pressure, temperature, gas_constant);
+  max_density = eos->density(range.max_pressure, temperature, gas_constant);
+  if (!(max_density > min_density))
+    throw std::invalid_argument("A pressure table needs a density increasing with pressure.");
+
+  const double spacing = (max_density - min_density)/n_intervals;
+  inverse_spacing = 1.0/spacing;
+
+  // Exact pressure and its derivative dp/drho = Z RT/(1 - rho RT dZ/dp) at the nodes
+  const double RT = gas_constant*temperature;
+  std::vector<double> p(n_intervals+1), dp(n_intervals+1);
+  for (int k = 0; k <= n_intervals; ++k) {
+    const double rho = min_density + k*spacing;
+    p[k]  = eos->pressure(rho, temperature, gas_constant);
+    dp[k] = eos->compressibility(p[k], temperature)*RT
+      / (1.0 - rho*RT*eos->compressibility_derivative(p[k], temperature));
+  }
+  end_pressure   = p.back();
+  end_derivative = dp.back();
+
+  // Hermite polynomials in t = (rho - rho_k)/h, with slopes scaled to the interval
+  coefficients.resize(n_intervals);
+  for (int k = 0; k < n_intervals; ++k) {
+    const double m0 = spacing*dp[k], m1 = spacing*dp[k+1];
+    coefficients[k] = {
+      p[k],
+      m0,
+      3.0*(p[k+1] - p[k]) - 2.0*m0 - m1,
+      2.0*(p[k] - p[k+1]) + m0 + m1
+    };
+  }
+}
+
+double PressureTable::pressure_derivative(const double density) const {
+  const double s = (density - min_density)*inverse_spacing;
+  if (s <= 0.0)
+    return coefficients.front()[1]*inverse_spacing;
+  if (s >= n_intervals)
+    return end_derivative;
+
+  const int k = std::min(static_cast<int>(s), n_intervals-1);
+  const auto& c = coefficients[k];
+  const double t = s - k;
+  return (c[1] + t*(2.0*c[2] + 3.0*t*c[3]))*inverse_spacing;
+}
+
+double PressureTable::density(const double pressure) const {
+  return eos->density(pressure, temperature, gas_constant);
+}
+
+std::size_t PressureTable::bytes() const {
+  return coefficients.capacity()*sizeof(coefficients[0]);
+}
+
+}
@@ -0,0 +1,224 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# include "feed.hpp"
+
+# include <algorithm>
+# include <cerrno>
+# include <cstring>
+# include <new>
+# include <stdexcept>
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+
+namespace {
+  constexpr std::uint64_t feed_magic   = 0x6465656673616770ull; // "pgasfeed"
+  constexpr std::uint32_t feed_version = 2;
+
+  std::uint64_t slot_size(const std::uint32_t n_state, const std::uint32_t n_pressure) {
+    return sizeof(phgasnets::FeedSlot) + (std::uint64_t(n_state) + n_pressure)*sizeof(double);
+  }
+
+  std::uint64_t slots_offset(const std::uint32_t n_pipes) {
+    return sizeof(phgasnets::FeedHeader) + std::uint64_t(n_pipes)*sizeof(phgasnets::FeedPipe);
+  }
+
+  phgasnets::FeedSlot* slot_at(void* memory, const phgasnets::FeedHeader& header, const std::uint64_t k) {
+    char* base = static_cast<char*>(memory) + slots_offset(header.n_pipes);
+    return reinterpret_cast<phgasnets::FeedSlot*>(base + (k % header.n_slots)*slot_size(header.n_state, header.n_pressure));
+  }
+
+  std::runtime_error feed_error(const std::string& what, const std::string& name) {
+    return std::runtime_error(what + " " + name + ": " + std::strerror(errno));
+  }
+}
+
+namespace phgasnets {
+
+SharedStateFeed::SharedStateFeed(
+  const std::string& name,
+  const DiscreteNetwork<double>& network,
+  const std::uint32_t n_slots
+) :
+  name(name),
+  network(network)
+{
+  const std::uint32_t n_pipes = network.pipes.size();
+  std::uint32_t n_pressure = 0;
+  for (const auto& pipe : network.pipes)
+    n_pressure += pipe.n_rho;
+  size = slots_offset(n_pipes) + std::max<std::uint32_t>(n_slots, 1)*slot_size(network.n_state, n_pressure);
+
+  int fd = shm_open(name.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0644);
+  if (fd < 0)
+    throw feed_error("Cannot create shared memory", name);
+  if (ftruncate(fd, size) != 0) {
+    close(fd);
+    shm_unlink(name.c_str());
+    throw feed_error("Cannot resize shared memory", name);
+  }
+  memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (memory == MAP_FAILED) {
+    shm_unlink(name.c_str());
+    throw feed_error("Cannot map shared memory", name);
+  }
+
+  // The zero-filled object holds no published state, magic is set last
+  header = new (memory) FeedHeader{0, feed_version, n_pipes, std::max<std::uint32_t>(n_slots, 1),
+                                   static_cast<std::uint32_t>(network.n_state), n_pressure, {0}};
+
+  FeedPipe* pipes = reinterpret_cast<FeedPipe*>(header + 1);
+  for (std::uint32_t p = 0; p < n_pipes; ++p) {
+    const auto& pipe = network.pipes[p];
+    pipes[p] = {pipe.n_rho, pipe.n_mom, pipe.length};
+  }
+  for (std::uint32_t k = 0; k < header->n_slots; ++k)
+    new (slot_at(memory, *header, k)) FeedSlot{{0}, 0.0, 0};
+
+  std::atomic_thread_fence(std::memory_order_release);
+  header->magic = feed_magic;
+}
+
+SharedStateFeed::~SharedStateFeed() {
+  munmap(memory, size);
+  shm_unlink(name.c_str());
+}
+
+void SharedStateFeed::publish(
+  const std::int64_t step,
+  const double time,
+  const Eigen::Ref<const Eigen::VectorXd>& state
+) {
+  const std::uint64_t k = header->published.load(std::memory_order_relaxed);
+  FeedSlot* slot = slot_at(memory, *header, k);
+
+  // Odd sequence while writing
+  const std::uint64_t sequence = slot->sequence.load(std::memory_order_relaxed);
+  slot->sequence.store(sequence+1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  slot->time = time;
+  slot->step = step;
+  double* values = reinterpret_cast<double*>(slot+1);
+  std::memcpy(values, state.data(), header->n_state*sizeof(double));
+
+  // Pressure at the density nodes, such that readers need no equation of state
+  double* pressure = values + header->n_state;
+  int pipe_state_startIdx = 0;
+  for (const auto& pipe : network.pipes) {
+    for (int i = 0; i < pipe.n_rho; ++i)
+      *pressure++ = pipe.pressure(state(pipe_state_startIdx+i));
+    pipe_state_startIdx += pipe.n_state;
+  }
+
+  slot->sequence.store(sequence+2, std::memory_order_release);
+  header->published.store(k+1, std::memory_order_release);
+}
+
+SharedStateFeedReader::SharedStateFeedReader(const std::string& name) {
+  int fd = shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd < 0)
+    throw feed_error("Cannot open shared memory", name);
+
+  struct stat info;
+  if (fstat(fd, &info) != 0) {
+    close(fd);
+    throw feed_error("Cannot stat shared memory", name);
+  }
+  size = info.st_size;
+  if (size < sizeof(FeedHeader)) {
+    close(fd);
+    throw std::runtime_error("Unknown live state feed format in " + name);
+  }
+
+  memory = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (memory == MAP_FAILED)
+    throw feed_error("Cannot map shared memory", name);
+
+  header = static_cast<const FeedHeader*>(memory);
+  if (header->magic != feed_magic || header->version != feed_version) {
+    munmap(memory, size);
+    throw std::runtime_error("Unknown live state feed format in " + name);
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+
+  // The header sizes are only trusted once the object is known to hold all they describe
+  const std::uint64_t expected_size = slots_offset(header->n_pipes)
+    + std::uint64_t(header->n_slots)*slot_size(header->n_state, header->n_pressure);
+  if (header->n_slots == 0 || size < expected_size) {
+    munmap(memory, size);
+    throw std::runtime_error("Truncated live state feed in " + name);
+  }
+
+  const FeedPipe* feed_pipes = reinterpret_cast<const FeedPipe*>(header + 1);
+  pipes.assign(feed_pipes, feed_pipes + header->n_pipes);
+
+  // Pipe sizes have to add up to the state and pressure sizes, which readers index by them
+  std::uint64_t n_state = 0, n_pressure = 0;
+  for (const auto& pipe : pipes) {
+    n_state    += std::uint64_t(std::max(pipe.n_rho, 0)) + std::uint64_t(std::max(pipe.n_mom, 0));
+    n_pressure += std::uint64_t(std::max(pipe.n_rho, 0));
+  }
+  if (n_state != header->n_state || n_pressure != header->n_pressure) {
+    munmap(memory, size);
+    throw std::runtime_error("Inconsistent live state feed in " + name);
+  }
+}
+
+SharedStateFeedReader::~SharedStateFeedReader() {
+  munmap(memory, size);
+}
+
+std::uint64_t SharedStateFeedReader::published() const {
+  return header->published.load(std::memory_order_acquire);
+}
+
+bool SharedStateFeedReader::read(
+  std::int64_t& step,
+  double& time,
+  Eigen::VectorXd& state
+) const {
+  Eigen::VectorXd pressure;
+  return read(step, time, state, pressure);
+}
+
+bool SharedStateFeedReader::read(
+  std::int64_t& step,
+  double& time,
+  Eigen::VectorXd& state,
+  Eigen::VectorXd& pressure
+) const {
+  state.resize(header->n_state);
+  pressure.resize(header->n_pressure);
+
+  while (true) {
+    const std::uint64_t k = header->published.load(std::memory_order_acquire);
+    if (k == 0)
+      return false;
+
+    const FeedSlot* slot = slot_at(memory, *header, k-1);
+    const std::uint64_t before = slot->sequence.load(std::memory_order_acquire);
+    if (before % 2 == 1)
+      continue;
+
+    time = slot->time;
+    step = slot->step;
+    const double* values = reinterpret_cast<const double*>(slot+1);
+    std::memcpy(state.data(), values, header->n_state*sizeof(double));
+    std::memcpy(pressure.data(), values + header->n_state, header->n_pressure*sizeof(double));
+
+    // Retry if the writer wrapped around onto this slot meanwhile
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot->sequence.load(std::memory_order_relaxed) == before)
+      return true;
+  }
+}
+
+}
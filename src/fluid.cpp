@@ -0,0 +1,25 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# include "fluid.hpp"
+
+namespace phgasnets {
+
+Fluid fluidFromJson(const nlohmann::json& params, const double gas_constant) {
+  if (!params.contains("equation_of_state"))
+    return Fluid(gas_constant);
+
+  TableRange table;
+  if (params.contains("pressure_table")) {
+    const auto& range  = params["pressure_table"];
+    table.min_pressure = range.value("min_pressure", table.min_pressure);
+    table.max_pressure = range.value("max_pressure", table.max_pressure);
+    table.nodes        = range.value("nodes", table.nodes);
+  }
+  return Fluid(gas_constant, equationOfStateFromJson(params["equation_of_state"]), table);
+}
+
+}
@@ -0,0 +1,87 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# include "footprint.hpp"
+
+# include <algorithm>
+# include <cstdio>
+# include <sstream>
+
+namespace {
+  // The first depth dot-separated components of a name
+  std::string truncate(const std::string& name, const int depth) {
+    std::size_t end = 0;
+    for (int k = 0; k < depth; ++k) {
+      end = name.find('.', end);
+      if (end == std::string::npos)
+        return name;
+      ++end;
+    }
+    return name.substr(0, end-1);
+  }
+
+  std::string human_readable(const std::size_t bytes) {
+    const char* units[] = {"B", "KiB", "MiB", "GiB", "TiB"};
+    double value = bytes;
+    int unit = 0;
+    while (value >= 1024.0 && unit < 4) {
+      value /= 1024.0;
+      ++unit;
+    }
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), unit == 0 ? "%.0f %s" : "%.1f %s", value, units[unit]);
+    return buffer;
+  }
+}
+
+namespace phgasnets {
+
+void MemoryFootprint::add(const std::string& name, const std::size_t bytes) {
+  auto entry = std::find_if(entries.begin(), entries.end(), [&name](const Entry& e) { return e.name == name; });
+  if (entry == entries.end())
+    entries.push_back({name, bytes});
+  else
+    entry->bytes += bytes;
+}
+
+void MemoryFootprint::add(const std::string& prefix, const MemoryFootprint& other) {
+  for (const auto& entry : other.entries)
+    add(prefix + "." + entry.name, entry.bytes);
+}
+
+std::size_t MemoryFootprint::total(const std::string& suffix) const {
+  std::size_t bytes = 0;
+  for (const auto& entry : entries)
+    if (entry.name.size() >= suffix.size()
+        && entry.name.compare(entry.name.size()-suffix.size(), suffix.size(), suffix) == 0)
+      bytes += entry.bytes;
+  return bytes;
+}
+
+std::string MemoryFootprint::summary(const int depth) const {
+  MemoryFootprint aggregated;
+  for (const auto& entry : entries)
+    aggregated.add(truncate(entry.name, depth), entry.bytes);
+
+  const std::size_t bytes = total();
+  std::size_t width = 5;
+  for (const auto& entry : aggregated.entries)
+    width = std::max(width, entry.name.size());
+
+  std::ostringstream table;
+  char line[64];
+  for (const auto& entry : aggregated.entries) {
+    std::snprintf(line, sizeof(line), "%12s %6.1f%%\n",
+      human_readable(entry.bytes).c_str(), bytes ? 100.0*entry.bytes/bytes : 0.0);
+    table << entry.name << std::string(width - entry.name.size(), ' ') << line;
+  }
+  std::snprintf(line, sizeof(line), "%12s", human_readable(bytes).c_str());
+  table << "total" << std::string(width - 5, ' ') << line
+        << " (" << human_readable(total(".triplets")) << " in triplet lists)";
+  return table.str();
+}
+
+}
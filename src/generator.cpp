@@ -0,0 +1,72 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# include "generator.hpp"
+# include "gasconstant.hpp"
+
+# include <cmath>
+# include <stdexcept>
+
+namespace phgasnets {
+
+SyntheticChain::SyntheticChain(
+  const int n_pipes,
+  const nlohmann::json& params
+) :
+  network(pipes, compressors, Fluid(params.value("gas_constant", get_gas_constant()))),
+  inlet_pressure(params.value("inlet_pressure", 8e6)),
+  momentum(params.value("momentum", 463.33))
+{
+  if (n_pipes < 2)
+    throw std::invalid_argument("A synthetic chain needs at least two pipes.");
+
+  const auto pipe_params = params.value("pipe", nlohmann::json::object());
+  const double length    = pipe_params.value("length", 20000.0);
+  const double diameter  = pipe_params.value("diameter", 1.422);
+  const double friction  = pipe_params.value("friction", 1.8e-3);
+  const double kappa     = params.value("isentropic_exponent", 1.4);
+  const double T_in      = params.value("inlet_temperature", 276.25);
+
+  const auto compressor_params = params.value("compressor", nlohmann::json::object());
+  const std::string type  = compressor_params.value("type", "FP");
+  const std::string model = compressor_params.value("model", "AM");
+
+  // Compression ratio restoring the inlet pressure after the stationary pressure drop of one pipe,
+  // p_out^2 = p_in^2 - f RT L m|m| / D
+  const double drop = friction*network.fluid.RT(T_in)*length*momentum*std::abs(momentum)/diameter;
+  const double outlet_pressure = std::sqrt(std::max(inlet_pressure*inlet_pressure - drop, 0.25*inlet_pressure*inlet_pressure));
+  const double ratio = inlet_pressure/outlet_pressure;
+
+  for (int k = 0; k < n_pipes-1; ++k) {
+    compressors.push_back(Compressor(type, model, type == "FC" ? ratio : inlet_pressure, kappa));
+    compressors.back().update_compression_ratio(ratio);
+  }
+
+  const double T_out = T_in * compressors[0].temperature_scale;
+  pipes.push_back(Pipe(length, diameter, friction, T_in));
+  for (int k = 1; k < n_pipes; ++k)
+    pipes.push_back(Pipe(length, diameter, friction, T_out));
+
+  input = Eigen::VectorXd::Zero(2*n_pipes);
+  input(0) = inlet_pressure;
+  for (int k = 0; k < n_pipes-1; ++k) {
+    const auto& compressor = compressors[k];
+    input(2*k+1) = compressor.model == "AV" ? 1.0/std::pow(compressor.specification, 1/kappa) : 1.0;
+    input(2*k+2) = compressor.specification;
+  }
+  input(2*n_pipes-1) = -momentum;
+}
+
+Eigen::VectorXd SyntheticChain::initial_guess(const int Nx) const {
+  Eigen::VectorXd state(pipes.size()*(2*Nx+2));
+  for (int p = 0; p < pipes.size(); ++p) {
+    state.segment(p*(2*Nx+2), Nx+1).setConstant(network.fluid.density(inlet_pressure, network.pipes[p].temperature));
+    state.segment(p*(2*Nx+2)+Nx+1, Nx+1).setConstant(momentum);
+  }
+  return state;
+}
+
+}
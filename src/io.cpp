@@ -5,38 +5,630 @@
 // SPDX-License-Identifier:  GPL-3.0-or-later
 
 # include "io.hpp"
+# include "trace.hpp"
+
+# include <cstdio>
+# include <iostream>
+# include <stdexcept>
+# include <algorithm>
+# include <chrono>
 
 namespace phgasnets{
 
+OutputLayout outputLayoutFromString(const std::string& layout) {
+  if (layout == "grouped")
+    return OutputLayout::Grouped;
+  if (layout == "timeseries")
+    return OutputLayout::TimeSeries;
+  throw std::invalid_argument("Unknown output layout " + layout + ", expected grouped or timeseries.");
+}
+
+std::recursive_mutex& hdf5Mutex() {
+  static std::recursive_mutex mutex;
+  return mutex;
+}
+
+OutputOptions outputOptionsFromJson(const nlohmann::json& io_params) {
+  OutputOptions options;
+  if (io_params.contains("layout"))
+    options.layout = outputLayoutFromString(io_params["layout"].get<std::string>());
+  if (io_params.contains("chunk_size"))
+    options.chunk_size = io_params["chunk_size"].get<std::size_t>();
+  if (io_params.contains("compression")) {
+    options.deflate_level = io_params["compression"].value("deflate", 0u);
+    options.shuffle       = io_params["compression"].value("shuffle", false);
+  }
+  if (io_params.contains("precision")) {
+    const auto precision = io_params["precision"].get<std::string>();
+    if (precision != "single" && precision != "double")
+      throw std::invalid_argument("Unknown output precision " + precision + ", expected single or double.");
+    options.single_precision = (precision == "single");
+  }
+  if (io_params.contains("pressure"))
+    options.write_pressure = io_params["pressure"].get<bool>();
+  if (io_params.contains("stride"))
+    options.space_stride = io_params["stride"].get<int>();
+  if (options.space_stride < 1)
+    throw std::invalid_argument("Output stride must be positive.");
+
+  return options;
+}
+
+namespace {
+  // Pressure of a real gas is only recoverable with its equation of state, so it is always written
+  OutputOptions withRealGasPressure(OutputOptions options, const DiscreteNetwork<double>& network) {
+    for (const auto& pipe : network.pipes)
+      if (pipe.pressure_table)
+        options.write_pressure = true;
+    return options;
+  }
+}
+
 NetworkStateWriter::NetworkStateWriter(
   const std::string& filename,
-  const DiscreteNetwork<double>& network
+  const DiscreteNetwork<double>& network,
+  const bool append,
+  const OutputOptions& options
 ) :
-  file(filename, H5Easy::File::Truncate),
-  network(network)
-{}
-
-void NetworkStateWriter::writeMesh() {
+  file(filename, append ? H5Easy::File::OpenOrCreate : H5Easy::File::Truncate),
+  network(network),
+  mode(append ? H5Easy::DumpMode::Overwrite : H5Easy::DumpMode::Create),
+  options(withRealGasPressure(options, network)),
+  n_rows(0)
+{
+  // RT scale of each ideal gas pipe, to recover pressure from density
   int counter = 0;
   for(auto& pipe: network.pipes){
+    // Every space_stride-th node, always including the outlet
+    std::vector<Eigen::Index> nodes;
+    for (Eigen::Index i = 0; i < pipe.rho.size(); i += options.space_stride)
+      nodes.push_back(i);
+    if (nodes.back() != pipe.rho.size()-1)
+      nodes.push_back(pipe.rho.size()-1);
+    pipe_nodes.push_back(nodes);
+
+    const Eigen::Index n_nodes = nodes.size();
+    if (n_nodes > pressure_buffer.size()) {
+      rho_buffer.resize(n_nodes);
+      mom_buffer.resize(n_nodes);
+      pressure_buffer.resize(n_nodes);
+    }
+
     auto h5path = "pipe" + std::to_string(counter++);
-    H5Easy::dump(file, h5path + "/mesh", pipe.mesh);
+    auto group = file.exist(h5path) ? file.getGroup(h5path) : file.createGroup(h5path);
+    if (!pipe.pressure_table && !group.hasAttribute("RT"))
+      group.createAttribute("RT", pipe.RT);
+  }
+
+  if (options.layout != OutputLayout::TimeSeries)
+    return;
+
+  // Rows of an existing file are appended to, which requires the datasets of the current options
+  time_dataset = openOrCreateTimeSeries("time", 0, false);
+  n_rows = time_dataset->getDimensions()[0];
+
+  for(std::size_t p = 0; p < network.pipes.size(); ++p){
+    auto h5path = "pipe" + std::to_string(p);
+    auto group = file.getGroup(h5path);
+    if (!group.hasAttribute("stride"))
+      group.createAttribute("stride", options.space_stride);
+    else if (group.getAttribute("stride").read<int>() != options.space_stride)
+      throw std::runtime_error(h5path + " in " + filename + " was written with another stride.");
+
+    const bool has_density = file.exist(h5path + "/density");
+    if (has_density && file.exist(h5path + "/pressure") != this->options.write_pressure)
+      throw std::runtime_error(h5path + " in " + filename + (this->options.write_pressure ?
+        " was written without pressure." : " was written with pressure."));
+
+    const std::size_t n_nodes = pipe_nodes[p].size();
+    PipeDataSets datasets = {
+      openOrCreateTimeSeries(h5path + "/density", n_nodes, this->options.single_precision),
+      std::nullopt,
+      openOrCreateTimeSeries(h5path + "/momentum", n_nodes, this->options.single_precision)
+    };
+    if (this->options.write_pressure)
+      datasets.pressure = openOrCreateTimeSeries(h5path + "/pressure", n_nodes, this->options.single_precision);
+    pipe_datasets.push_back(datasets);
   }
 }
 
-void NetworkStateWriter::writeState(const int& timetag, const int& time) {
+HighFive::DataSet NetworkStateWriter::openOrCreateTimeSeries(
+  const std::string& path,
+  const std::size_t n_nodes,
+  const bool single_precision
+) {
+  if (file.exist(path)) {
+    auto dataset = file.getDataSet(path);
+    const auto dims = dataset.getDimensions();
+    const std::size_t rank = (n_nodes > 0) ? 2 : 1;
+    if (dims.size() != rank || (n_nodes > 0 && dims[1] != n_nodes))
+      throw std::runtime_error(path + " in " + file.getName() + " does not match the network resolution and stride.");
+    // A row beyond the last time, left by an interrupted write, is overwritten by the next one
+    if (n_nodes > 0 && dims[0] < n_rows)
+      throw std::runtime_error(path + " in " + file.getName() + " has fewer rows than time.");
+    if (dataset.getDataType().getSize() != (single_precision ? sizeof(float) : sizeof(double)))
+      throw std::runtime_error(path + " in " + file.getName() + " was written with another precision.");
+    return dataset;
+  }
 
-  int counter = 0;
-  for(auto& pipe: network.pipes){
-    Eigen::VectorXd rho = pipe.rho;
-    Eigen::VectorXd mom = pipe.mom;
+  // (time x nodes) matrices, or a time vector if n_nodes is zero, unlimited in time
+  std::vector<std::size_t> dims = {0}, max_dims = {HighFive::DataSpace::UNLIMITED};
+  std::vector<hsize_t> chunk = {options.chunk_size};
+  if (n_nodes > 0) {
+    dims.push_back(n_nodes);
+    max_dims.push_back(n_nodes);
+    chunk.push_back(n_nodes);
+  }
+
+  // Rows are written from double buffers, HDF5 converts on write
+  HighFive::DataSpace space(dims, max_dims);
+  if (single_precision)
+    return file.createDataSet<float>(path, space, fieldProperties(chunk));
+  return file.createDataSet<double>(path, space, fieldProperties(chunk));
+}
+
+HighFive::DataSetCreateProps NetworkStateWriter::fieldProperties(const std::vector<hsize_t>& chunk) const {
+  HighFive::DataSetCreateProps props;
+  props.add(HighFive::Chunking(chunk));
+  if (options.shuffle)
+    props.add(HighFive::Shuffle());
+  if (options.deflate_level > 0)
+    props.add(HighFive::Deflate(options.deflate_level));
+  return props;
+}
+
+void NetworkStateWriter::writeField(
+  const std::string& path,
+  const double* data,
+  const std::size_t n_nodes
+) {
+  std::optional<HighFive::DataSet> dataset;
+  if (mode == H5Easy::DumpMode::Overwrite && file.exist(path)) {
+    dataset = file.getDataSet(path);
+  }
+  else {
+    // Filters need a chunked layout, a single chunk per time step
+    HighFive::DataSetCreateProps props;
+    if (options.shuffle || options.deflate_level > 0)
+      props = fieldProperties({n_nodes});
+
+    HighFive::DataSpace space({n_nodes});
+    if (options.single_precision)
+      dataset = file.createDataSet<float>(path, space, props);
+    else
+      dataset = file.createDataSet<double>(path, space, props);
+  }
+  dataset->write_raw(data);
+}
+
+const double* NetworkStateWriter::gather(
+  const std::size_t p,
+  const double* field,
+  Eigen::VectorXd& buffer
+) const {
+  const auto& nodes = pipe_nodes[p];
+  if (options.space_stride == 1)
+    return field;
+
+  for (std::size_t i = 0; i < nodes.size(); ++i)
+    buffer(i) = field[nodes[i]];
+  return buffer.data();
+}
+
+void NetworkStateWriter::appendRow(
+  HighFive::DataSet& dataset,
+  const double* data,
+  const std::size_t n_nodes
+) {
+  if (n_nodes > 0) {
+    dataset.resize({n_rows+1, n_nodes});
+    dataset.select({n_rows, 0}, {1, n_nodes}).write_raw(data);
+  }
+  else {
+    dataset.resize({n_rows+1});
+    dataset.select({n_rows}, {1}).write_raw(data);
+  }
+}
+
+void NetworkStateWriter::writeMesh() {
+  for(std::size_t p = 0; p < network.pipes.size(); ++p){
+    auto h5path = "pipe" + std::to_string(p);
+    H5Easy::dump(file, h5path + "/mesh", Eigen::VectorXd(network.pipes[p].mesh(pipe_nodes[p])), mode);
+  }
+}
+
+void NetworkStateWriter::writeState(const int& timetag, const double& time) {
+  PHGASNETS_TRACE_SCOPE("writeState");
+  for(std::size_t p = 0; p < network.pipes.size(); ++p){
+    const auto& pipe = network.pipes[p];
+    writePipeState(p, timetag, time, pipe.rho.data(), pipe.mom.data());
+  }
+  writeTime(time);
+}
+
+void NetworkStateWriter::writeState(
+  const int& timetag,
+  const double& time,
+  const Eigen::Ref<const Eigen::VectorXd>& state
+) {
+  PHGASNETS_TRACE_SCOPE("writeState");
+  int pipe_state_startIdx = 0;
+  for(std::size_t p = 0; p < network.pipes.size(); ++p){
+    const auto& pipe = network.pipes[p];
+    const double* rho = state.data() + pipe_state_startIdx;
+    writePipeState(p, timetag, time, rho, rho + pipe.n_rho);
+    pipe_state_startIdx += pipe.n_state;
+  }
+  writeTime(time);
+}
+
+void NetworkStateWriter::writePipeState(
+  const std::size_t p,
+  const int& timetag,
+  const double& time,
+  const double* rho,
+  const double* mom
+) {
+  const auto& pipe = network.pipes[p];
+  const std::size_t n_nodes = pipe_nodes[p].size();
+
+  // Written nodes, without a copy unless strided
+  const double* rho_out = gather(p, rho, rho_buffer);
+  const double* mom_out = gather(p, mom, mom_buffer);
+
+  const bool write_pressure = (options.layout == OutputLayout::TimeSeries) ?
+    pipe_datasets[p].pressure.has_value() : options.write_pressure;
+  if (write_pressure) {
+    if (pipe.pressure_table)
+      for (std::size_t i = 0; i < n_nodes; ++i)
+        pressure_buffer(i) = pipe.pressure(rho_out[i]);
+    else
+      pressure_buffer.head(n_nodes) =
+        Eigen::Map<const Eigen::VectorXd>(rho_out, n_nodes) * pipe.RT;
+  }
+
+  if (options.layout == OutputLayout::TimeSeries) {
+    appendRow(pipe_datasets[p].density, rho_out, n_nodes);
+    if (write_pressure)
+      appendRow(*pipe_datasets[p].pressure, pressure_buffer.data(), n_nodes);
+    appendRow(pipe_datasets[p].momentum, mom_out, n_nodes);
+    return;
+  }
+
+  auto h5path = "pipe" + std::to_string(p) + "/" + std::to_string(timetag);
+  writeField(h5path + "/density", rho_out, n_nodes);
+  if (write_pressure)
+    writeField(h5path + "/pressure", pressure_buffer.data(), n_nodes);
+  writeField(h5path + "/momentum", mom_out, n_nodes);
+  H5Easy::dump(file, h5path + "/timestamp", time, mode);
+}
+
+void NetworkStateWriter::writeTime(const double& time) {
+  if (options.layout != OutputLayout::TimeSeries)
+    return;
+
+  appendRow(*time_dataset, &time, 0);
+  ++n_rows;
+}
+
+void NetworkStateWriter::discardAfter(const double time) {
+  if (options.layout != OutputLayout::TimeSeries || n_rows == 0)
+    return;
+
+  std::vector<double> times(n_rows);
+  time_dataset->read(times);
+  n_rows = std::upper_bound(times.begin(), times.end(), time) - times.begin();
+
+  for(std::size_t p = 0; p < network.pipes.size(); ++p){
+    const std::size_t n_nodes = pipe_nodes[p].size();
+    pipe_datasets[p].density.resize({n_rows, n_nodes});
+    if (pipe_datasets[p].pressure)
+      pipe_datasets[p].pressure->resize({n_rows, n_nodes});
+    pipe_datasets[p].momentum.resize({n_rows, n_nodes});
+  }
+  time_dataset->resize({n_rows});
+}
+
+AsyncNetworkStateWriter::AsyncNetworkStateWriter(
+  const std::string& filename,
+  const DiscreteNetwork<double>& network,
+  const bool append,
+  const OutputOptions& options,
+  const std::size_t queue_depth
+) :
+  buffers(std::max<std::size_t>(queue_depth, 1), Eigen::VectorXd(network.n_state)),
+  writing(false),
+  stop(false),
+  total_write_time(0.0)
+{
+  {
+    std::lock_guard<std::recursive_mutex> hdf5_lock(hdf5Mutex());
+    writer.emplace(filename, network, append, options);
+  }
+  for (std::size_t b = buffers.size(); b-- > 0; )
+    free_buffers.push_back(b);
+  worker = std::thread(&AsyncNetworkStateWriter::run, this);
+}
+
+AsyncNetworkStateWriter::~AsyncNetworkStateWriter() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stop = true;
+  }
+  job_queued.notify_one();
+  worker.join();
 
-    auto h5path = "pipe" + std::to_string(counter++) + "/" + std::to_string(timetag);
-    H5Easy::dump(file, h5path + "/density", rho);
-    H5Easy::dump(file, h5path + "/pressure", rho*phgasnets::GAS_CONSTANT*pipe.temperature);
-    H5Easy::dump(file, h5path + "/momentum", mom);
-    H5Easy::dump(file, h5path + "/timestamp", time);
+  {
+    std::lock_guard<std::recursive_mutex> hdf5_lock(hdf5Mutex());
+    writer.reset();
   }
+
+  // Destructors must not throw, report what flush() would have rethrown
+  if (error) {
+    try {
+      std::rethrow_exception(error);
+    }
+    catch (const std::exception& e) {
+      std::cerr << "Writing network states failed: " << e.what() << std::endl;
+    }
+    catch (...) {
+      std::cerr << "Writing network states failed" << std::endl;
+    }
+  }
+}
+
+void AsyncNetworkStateWriter::writeMesh() {
+  flush();
+  std::lock_guard<std::recursive_mutex> hdf5_lock(hdf5Mutex());
+  writer->writeMesh();
+}
+
+void AsyncNetworkStateWriter::discardAfter(const double time) {
+  flush();
+  std::lock_guard<std::recursive_mutex> hdf5_lock(hdf5Mutex());
+  writer->discardAfter(time);
+}
+
+void AsyncNetworkStateWriter::writeState(
+  const int& timetag,
+  const double& time,
+  const Eigen::Ref<const Eigen::VectorXd>& state
+) {
+  PHGASNETS_TRACE_SCOPE("queueState");
+  std::size_t buffer;
+  {
+    // Backpressure: wait for a free buffer
+    std::unique_lock<std::mutex> lock(mutex);
+    job_done.wait(lock, [this]{ return !free_buffers.empty() || error; });
+    rethrow();
+    buffer = free_buffers.back();
+    free_buffers.pop_back();
+  }
+
+  // The buffer is owned by this thread until queued
+  buffers[buffer] = state;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    jobs.push_back({buffer, timetag, time});
+  }
+  job_queued.notify_one();
+}
+
+void AsyncNetworkStateWriter::flush() {
+  std::unique_lock<std::mutex> lock(mutex);
+  job_done.wait(lock, [this]{ return (jobs.empty() && !writing) || error; });
+  rethrow();
+}
+
+double AsyncNetworkStateWriter::write_time() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return total_write_time;
+}
+
+void AsyncNetworkStateWriter::rethrow() {
+  if (error) {
+    auto e = error;
+    error = nullptr;
+    std::rethrow_exception(e);
+  }
+}
+
+void AsyncNetworkStateWriter::run() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    job_queued.wait(lock, [this]{ return !jobs.empty() || stop; });
+    if (jobs.empty())
+      return;
+
+    Job job = jobs.front();
+    jobs.pop_front();
+    writing = true;
+    lock.unlock();
+
+    std::exception_ptr job_error;
+    const auto start = std::chrono::steady_clock::now();
+    try {
+      std::lock_guard<std::recursive_mutex> hdf5_lock(hdf5Mutex());
+      writer->writeState(job.timetag, job.time, buffers[job.buffer]);
+    }
+    catch (...) {
+      job_error = std::current_exception();
+    }
+    const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+
+    lock.lock();
+    writing = false;
+    total_write_time += duration.count();
+    free_buffers.push_back(job.buffer);
+    if (job_error && !error)
+      error = job_error;
+    job_done.notify_all();
+  }
+}
+
+namespace {
+  OutputLayout detectLayout(const H5Easy::File& file) {
+    return file.exist("time") ? OutputLayout::TimeSeries : OutputLayout::Grouped;
+  }
+}
+
+NetworkStateReader::NetworkStateReader(
+  const std::string& filename,
+  const DiscreteNetwork<double>& network
+) :
+  network(network)
+{
+  std::lock_guard<std::recursive_mutex> hdf5_lock(hdf5Mutex());
+  file.emplace(filename, H5Easy::File::ReadOnly);
+  layout = detectLayout(*file);
+
+  if (layout == OutputLayout::TimeSeries) {
+    file->getDataSet("time").read(time_steps);
+    for(std::size_t p = 0; p < network.pipes.size(); ++p){
+      const auto dims = file->getDataSet("pipe" + std::to_string(p) + "/density").getDimensions();
+      if (dims[1] != static_cast<std::size_t>(network.pipes[p].n_rho))
+        throw std::runtime_error("Pipe " + std::to_string(p) + " in " + filename + " does not match the network resolution.");
+    }
+    return;
+  }
+
+  // Grouped layout: numeric subgroups of the first pipe, sorted by timetag
+  std::vector<long> tags;
+  for (const auto& name : file->getGroup("pipe0").listObjectNames()) {
+    if (!name.empty() && name.find_first_not_of("0123456789") == std::string::npos)
+      tags.push_back(std::stol(name));
+  }
+  std::sort(tags.begin(), tags.end());
+
+  for (const long tag : tags) {
+    timetags.push_back(std::to_string(tag));
+    time_steps.push_back(H5Easy::load<double>(*file, "pipe0/" + timetags.back() + "/timestamp"));
+  }
+  if (!tags.empty()) {
+    for(std::size_t p = 0; p < network.pipes.size(); ++p){
+      const auto n = H5Easy::getSize(*file, "pipe" + std::to_string(p) + "/" + timetags[0] + "/density");
+      if (n != static_cast<std::size_t>(network.pipes[p].n_rho))
+        throw std::runtime_error("Pipe " + std::to_string(p) + " in " + filename + " does not match the network resolution.");
+    }
+  }
+}
+
+NetworkStateReader::~NetworkStateReader() {
+  std::lock_guard<std::recursive_mutex> hdf5_lock(hdf5Mutex());
+  file.reset();
+}
+
+std::size_t NetworkStateReader::index_at(const double time) const {
+  auto it = std::upper_bound(time_steps.begin(), time_steps.end(), time);
+  if (it == time_steps.begin())
+    throw std::out_of_range("No time step at or before t = " + std::to_string(time) + "s.");
+  return (it - time_steps.begin()) - 1;
+}
+
+std::vector<double> NetworkStateReader::readPipeField(
+  const std::size_t pipe,
+  const std::string& field,
+  const std::size_t index
+) const {
+  std::lock_guard<std::recursive_mutex> hdf5_lock(hdf5Mutex());
+  std::vector<double> values;
+  if (layout == OutputLayout::TimeSeries) {
+    const auto dataset = file->getDataSet("pipe" + std::to_string(pipe) + "/" + field);
+    const std::size_t n_nodes = dataset.getDimensions()[1];
+    dataset.select({index, 0}, {1, n_nodes}).read(values);
+  }
+  else {
+    file->getDataSet("pipe" + std::to_string(pipe) + "/" + timetags[index] + "/" + field).read(values);
+  }
+  return values;
+}
+
+Eigen::VectorXd NetworkStateReader::state(const std::size_t index) const {
+  if (index >= size())
+    throw std::out_of_range("Time step " + std::to_string(index) + " exceeds the " + std::to_string(size()) + " stored steps.");
+
+  Eigen::VectorXd state(network.n_state);
+  int pipe_state_startIdx = 0;
+  for(std::size_t p = 0; p < network.pipes.size(); ++p){
+    const auto& pipe = network.pipes[p];
+    const auto rho = readPipeField(p, "density", index);
+    const auto mom = readPipeField(p, "momentum", index);
+    state.segment(pipe_state_startIdx, pipe.n_rho) = Eigen::Map<const Eigen::VectorXd>(rho.data(), pipe.n_rho);
+    state.segment(pipe_state_startIdx+pipe.n_rho, pipe.n_mom) = Eigen::Map<const Eigen::VectorXd>(mom.data(), pipe.n_mom);
+    pipe_state_startIdx += pipe.n_state;
+  }
+  return state;
+}
+
+void NetworkStateReader::load(const std::size_t index, DiscreteNetwork<double>& network) const {
+  network.set_state(state(index));
+}
+
+Eigen::MatrixXd NetworkStateReader::history(const std::size_t pipe, const std::string& field) const {
+  std::lock_guard<std::recursive_mutex> hdf5_lock(hdf5Mutex());
+  const std::string h5path = "pipe" + std::to_string(pipe);
+  const bool derived = (field == "pressure") && !(
+    (layout == OutputLayout::TimeSeries) ? file->exist(h5path + "/pressure") :
+    (size() > 0 && file->exist(h5path + "/" + timetags[0] + "/pressure"))
+  );
+  const std::string stored = derived ? "density" : field;
+
+  Eigen::MatrixXd values(size(), network.pipes[pipe].n_rho);
+  if (layout == OutputLayout::TimeSeries) {
+    // A single contiguous read of the whole (time x nodes) dataset
+    std::vector<std::vector<double>> rows;
+    file->getDataSet(h5path + "/" + stored).read(rows);
+    for (std::size_t n = 0; n < rows.size(); ++n)
+      values.row(n) = Eigen::Map<const Eigen::RowVectorXd>(rows[n].data(), rows[n].size());
+  }
+  else {
+    for (std::size_t n = 0; n < size(); ++n) {
+      const auto row = readPipeField(pipe, stored, n);
+      values.row(n) = Eigen::Map<const Eigen::RowVectorXd>(row.data(), row.size());
+    }
+  }
+
+  if (derived && network.pipes[pipe].pressure_table)
+    values = values.unaryExpr([&p = network.pipes[pipe]](const double rho) { return p.pressure(rho); });
+  else if (derived)
+    values *= H5Easy::loadAttribute<double>(*file, h5path, "RT");
+  return values;
+}
+
+void writeCheckpoint(const std::string& filename, const Checkpoint& checkpoint) {
+  std::lock_guard<std::recursive_mutex> hdf5_lock(hdf5Mutex());
+  const std::string tmp_filename = filename + ".tmp";
+  {
+    H5Easy::File file(tmp_filename, H5Easy::File::Truncate);
+    H5Easy::dump(file, "/network_hash", checkpoint.network_hash);
+    H5Easy::dump(file, "/state", checkpoint.state);
+    H5Easy::dump(file, "/input", checkpoint.input);
+    H5Easy::dump(file, "/time", checkpoint.time);
+    H5Easy::dump(file, "/step", checkpoint.step);
+    H5Easy::dump(file, "/timestep", checkpoint.timestep);
+    H5Easy::dump(file, "/solver/function_tolerance", checkpoint.function_tolerance);
+    H5Easy::dump(file, "/solver/max_num_iterations", checkpoint.max_num_iterations);
+  }
+  if (std::rename(tmp_filename.c_str(), filename.c_str()) != 0)
+    throw std::runtime_error("Cannot move checkpoint to " + filename);
+}
+
+Checkpoint readCheckpoint(const std::string& filename) {
+  std::lock_guard<std::recursive_mutex> hdf5_lock(hdf5Mutex());
+  H5Easy::File file(filename, H5Easy::File::ReadOnly);
+
+  Checkpoint checkpoint;
+  checkpoint.network_hash       = H5Easy::load<std::string>(file, "/network_hash");
+  checkpoint.state              = H5Easy::load<Eigen::VectorXd>(file, "/state");
+  checkpoint.input              = H5Easy::load<Eigen::VectorXd>(file, "/input");
+  checkpoint.time               = H5Easy::load<double>(file, "/time");
+  checkpoint.step               = H5Easy::load<int>(file, "/step");
+  checkpoint.timestep           = H5Easy::load<double>(file, "/timestep");
+  checkpoint.function_tolerance = H5Easy::load<double>(file, "/solver/function_tolerance");
+  checkpoint.max_num_iterations = H5Easy::load<int>(file, "/solver/max_num_iterations");
+
+  return checkpoint;
 }
 
 }
@@ -27,13 +27,28 @@ Et_operator::Et_operator(
     const int n_mom
 ) :
     BaseOperator<double>(n_rho, n_mom),
-    E(E_operator(n_rho, n_mom))
+    E(std::in_place, n_rho, n_mom)
 {
-    data = E.data;
+    data = E->data;
     mat.resize(n_rho+n_mom+2, n_rho+n_mom);
     mat.setFromTriplets(data.begin(), data.end());
 }
 
+Et_operator::Et_operator(
+    const int n_rho,
+    const int n_mom,
+    const Eigen::Ref<const Eigen::SparseMatrix<double>>& mat
+) :
+    BaseOperator<double>(n_rho, n_mom, mat)
+{}
+
+MemoryFootprint Et_operator::footprint() const {
+    MemoryFootprint memory = BaseOperator<double>::footprint();
+    if (E)
+        memory.add("E", E->footprint());
+    return memory;
+}
+
 // U matrix constructor
 U_operator::U_operator(
     const int n_rho,
@@ -70,7 +85,7 @@ J_operator::J_operator(
         triplet = Eigen::Triplet<double>(n_rho+triplet.row(), triplet.col(), -triplet.value());
 
     // Concatenate these triplets to form triplets for J operator
-    data.resize(3*n_rho+3*n_mom);
+    data.reserve(dx_1.size()+dx_2.size());
     data.insert(data.end(), dx_1.begin(), dx_1.end());
     data.insert(data.end(), dx_2.begin(), dx_2.end());
 
@@ -86,15 +101,15 @@ Jt_operator::Jt_operator(
     const double mesh_width
 ) :
     BaseOperator<double>(n_rho, n_mom),
-    J(J_operator(n_rho, n_mom, mesh_width)),
-    U(U_operator(n_rho, n_mom))
+    J(std::in_place, n_rho, n_mom, mesh_width),
+    U(std::in_place, n_rho, n_mom)
 {
     // Add the J_operator triplets as is into Jt
-    data.resize(3*n_rho+3*n_mom+2);
-    data.insert(data.end(), J.data.begin(), J.data.end());
+    data.reserve(J->data.size()+U->data.size());
+    data.insert(data.end(), J->data.begin(), J->data.end());
 
     // Add the U_operator triplets with row offset and negative value.
-    for (auto& triplet : U.data)
+    for (auto& triplet : U->data)
         data.push_back(Eigen::Triplet<double>(n_rho+n_mom+triplet.row(), triplet.col(), -triplet.value()));
 
     // Create matrix operator
@@ -102,6 +117,23 @@ Jt_operator::Jt_operator(
     mat.setFromTriplets(data.begin(), data.end());
 }
 
+Jt_operator::Jt_operator(
+    const int n_rho,
+    const int n_mom,
+    const Eigen::Ref<const Eigen::SparseMatrix<double>>& mat
+) :
+    BaseOperator<double>(n_rho, n_mom, mat)
+{}
+
+MemoryFootprint Jt_operator::footprint() const {
+    MemoryFootprint memory = BaseOperator<double>::footprint();
+    if (J)
+        memory.add("J", J->footprint());
+    if (U)
+        memory.add("U", U->footprint());
+    return memory;
+}
+
 // Y_operator constructor
 Y_operator::Y_operator(
     const int n_rho,
@@ -0,0 +1,190 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# include "output.hpp"
+
+# include <cmath>
+# include <stdexcept>
+# include <string>
+
+namespace phgasnets {
+
+std::vector<Probe> probesFromJson(const nlohmann::json& locations) {
+  std::vector<Probe> probes;
+  for (const auto& location : locations) {
+    probes.push_back({
+      location["name"].get<std::string>(),
+      location["pipe"].get<int>(),
+      location["position"].get<double>()
+    });
+  }
+  return probes;
+}
+
+ProbeRecorder::ProbeRecorder(
+  const DiscreteNetwork<double>& network,
+  const std::vector<Probe>& probes,
+  const int frequency
+) :
+  probes(probes),
+  frequency(frequency),
+  pressure_series(probes.size()),
+  momentum_series(probes.size()),
+  pressure_stats(probes.size()),
+  momentum_stats(probes.size()),
+  row(2*probes.size()+1)
+{
+  if (frequency < 1)
+    throw std::invalid_argument("The probe frequency must be at least 1, got " + std::to_string(frequency) + ".");
+
+  std::vector<int> pipe_state_startIdx = {0};
+  for (const auto& pipe : network.pipes)
+    pipe_state_startIdx.push_back(pipe_state_startIdx.back() + pipe.n_state);
+
+  for (const auto& probe : probes) {
+    if (probe.pipe < 0 || probe.pipe >= static_cast<int>(network.pipes.size()))
+      throw std::out_of_range("Probe " + probe.name + " refers to a non-existing pipe.");
+
+    const auto& pipe = network.pipes[probe.pipe];
+    if (!(probe.position >= 0.0 && probe.position <= pipe.length))
+      throw std::out_of_range("Probe " + probe.name + " lies outside of its pipe.");
+
+    // Cell containing the probe, the last cell includes the outlet
+    const double x = probe.position/pipe.mesh_width;
+    const int cell = std::min(static_cast<int>(std::floor(x)), pipe.n_x-1);
+
+    stencils.push_back({
+      pipe_state_startIdx[probe.pipe] + cell,
+      pipe.n_rho,
+      x - cell,
+      pipe.RT,
+      pipe.pressure_table
+    });
+  }
+}
+
+void ProbeRecorder::record(
+  const int timetag,
+  const double time,
+  const Eigen::Ref<const Eigen::VectorXd>& state
+) {
+  const bool keep = (timetag % frequency == 0);
+  if (keep && !csv)
+    time_series.push_back(time);
+  row[0] = time;
+
+  for (std::size_t k = 0; k < stencils.size(); ++k) {
+    const auto& s = stencils[k];
+    const double rho = (1.0-s.weight)*state(s.left) + s.weight*state(s.left+1);
+    const double mom = (1.0-s.weight)*state(s.left+s.n_rho) + s.weight*state(s.left+s.n_rho+1);
+    const double pressure = s.pressure_table ? s.pressure_table->pressure(rho) : s.RT*rho;
+
+    pressure_stats[k].add(pressure);
+    momentum_stats[k].add(mom);
+    row[2*k+1] = pressure;
+    row[2*k+2] = mom;
+    if (keep && !csv) {
+      pressure_series[k].push_back(pressure);
+      momentum_series[k].push_back(mom);
+    }
+  }
+
+  if (keep && csv)
+    csv->writeRow(row.data());
+}
+
+void ProbeRecorder::writeCSV(const std::string& filename) const {
+  std::vector<std::string> column_names = {"time"};
+  std::vector<std::vector<double>> columns = {time_series};
+  for (std::size_t k = 0; k < probes.size(); ++k) {
+    column_names.push_back(probes[k].name + "_pressure");
+    column_names.push_back(probes[k].name + "_momentum");
+    columns.push_back(pressure_series[k]);
+    columns.push_back(momentum_series[k]);
+  }
+  writeColumnsToCSV(filename, column_names, columns);
+}
+
+void ProbeRecorder::streamCSV(const std::string& filename) {
+  std::vector<std::string> column_names = {"time"};
+  for (const auto& probe : probes) {
+    column_names.push_back(probe.name + "_pressure");
+    column_names.push_back(probe.name + "_momentum");
+  }
+  csv = std::make_unique<CSVWriter>(filename, column_names);
+}
+
+nlohmann::json ProbeRecorder::statistics() const {
+  nlohmann::json stats;
+  for (std::size_t k = 0; k < probes.size(); ++k) {
+    stats[probes[k].name] = {
+      {"pressure", pressure_stats[k].to_json()},
+      {"momentum", momentum_stats[k].to_json()}
+    };
+  }
+  return stats;
+}
+
+NetworkStatistics::NetworkStatistics(const DiscreteNetwork<double>& network) :
+  network(network),
+  pressure_min(network.pipes.size()),
+  pressure_max(network.pipes.size()),
+  pipe_linepack(network.pipes.size())
+{}
+
+Eigen::VectorXd NetworkStatistics::linepack(const Eigen::Ref<const Eigen::VectorXd>& state) const {
+  Eigen::VectorXd mass(network.pipes.size());
+
+  int pipe_state_startIdx = 0;
+  for (std::size_t p = 0; p < network.pipes.size(); ++p) {
+    const auto& pipe = network.pipes[p];
+    auto rho = state.segment(pipe_state_startIdx, pipe.n_rho);
+
+    const double area = M_PI * pipe.diameter * pipe.diameter / 4.0;
+    const double integral = pipe.mesh_width * (rho.sum() - 0.5*(rho(0) + rho(Eigen::last)));
+    mass(p) = area * integral;
+
+    pipe_state_startIdx += pipe.n_state;
+  }
+  return mass;
+}
+
+void NetworkStatistics::record(const Eigen::Ref<const Eigen::VectorXd>& state) {
+  Eigen::VectorXd mass = linepack(state);
+  total_linepack.add(mass.sum());
+
+  int pipe_state_startIdx = 0;
+  for (std::size_t p = 0; p < network.pipes.size(); ++p) {
+    const auto& pipe = network.pipes[p];
+    auto rho = state.segment(pipe_state_startIdx, pipe.n_rho);
+
+    // Pressure increases with density, also for a real gas
+    pressure_min[p].add(pipe.pressure(rho.minCoeff()));
+    pressure_max[p].add(pipe.pressure(rho.maxCoeff()));
+    pipe_linepack[p].add(mass(p));
+
+    pipe_state_startIdx += pipe.n_state;
+  }
+}
+
+nlohmann::json NetworkStatistics::to_json() const {
+  nlohmann::json stats;
+  for (std::size_t p = 0; p < network.pipes.size(); ++p) {
+    stats["pipe" + std::to_string(p)] = {
+      {"pressure", {
+        {"min", pressure_min[p].min},
+        {"max", pressure_max[p].max},
+        {"mean_min", pressure_min[p].mean},
+        {"mean_max", pressure_max[p].mean}
+      }},
+      {"linepack", pipe_linepack[p].to_json()}
+    };
+  }
+  stats["linepack"] = total_linepack.to_json();
+  return stats;
+}
+
+}
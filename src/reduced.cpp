@@ -0,0 +1,213 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# include "reduced.hpp"
+
+# include <cmath>
+# include <algorithm>
+# include <stdexcept>
+# include <Eigen/SVD>
+# include <Eigen/LU>
+
+namespace phgasnets {
+
+void Snapshots::add(const Eigen::Ref<const Eigen::VectorXd>& state) {
+  states.push_back(state);
+}
+
+Eigen::MatrixXd Snapshots::matrix() const {
+  if (states.empty()) return Eigen::MatrixXd();
+
+  Eigen::MatrixXd result(states[0].size(), states.size());
+  for (int j = 0; j < states.size(); ++j)
+    result.col(j) = states[j];
+
+  return result;
+}
+
+Eigen::MatrixXd pod_basis(
+  const Eigen::Ref<const Eigen::MatrixXd>& snapshots,
+  const double tolerance,
+  const int max_rank
+) {
+  Eigen::BDCSVD<Eigen::MatrixXd> svd(snapshots, Eigen::ComputeThinU);
+  const Eigen::VectorXd& sigma = svd.singularValues();
+
+  // Retain the leading modes until the discarded energy drops below the tolerance
+  const double total_energy = sigma.squaredNorm();
+  const int max_modes = std::min<int>(max_rank, sigma.size());
+  double retained_energy = 0.0;
+  int rank = 0;
+  while (rank < max_modes && retained_energy < (1.0 - tolerance) * total_energy) {
+    retained_energy += sigma(rank) * sigma(rank);
+    ++rank;
+  }
+
+  return svd.matrixU().leftCols(std::max(rank, 1));
+}
+
+std::vector<int> deim_indices(const Eigen::Ref<const Eigen::MatrixXd>& basis) {
+  std::vector<int> indices;
+  indices.reserve(basis.cols());
+
+  Eigen::Index idx;
+  basis.col(0).cwiseAbs().maxCoeff(&idx);
+  indices.push_back(idx);
+
+  for (int l = 1; l < basis.cols(); ++l) {
+    // Interpolate the l-th basis vector with the previous ones at the chosen indices
+    Eigen::MatrixXd PtU = basis(indices, Eigen::seqN(0, l));
+    Eigen::VectorXd coeffs = PtU.partialPivLu().solve(basis.col(l)(indices));
+    Eigen::VectorXd residual = basis.col(l) - basis.leftCols(l) * coeffs;
+
+    residual.cwiseAbs().maxCoeff(&idx);
+    indices.push_back(idx);
+  }
+
+  return indices;
+}
+
+Eigen::VectorXd ReducedNetwork::project(const Eigen::Ref<const Eigen::VectorXd>& state) const {
+  Eigen::VectorXd reduced_state(n_state);
+
+  int startIdx = 0, reduced_startIdx = 0;
+  for (const auto& pipe : pipes) {
+    const int n_rho = pipe.V_rho.rows();
+    const int n_mom = pipe.V_mom.rows();
+    reduced_state.segment(reduced_startIdx, pipe.n_rho) =
+      pipe.V_rho.transpose() * (state.segment(startIdx, n_rho) - pipe.rho_ref);
+    reduced_state.segment(reduced_startIdx+pipe.n_rho, pipe.n_mom) =
+      pipe.V_mom.transpose() * (state.segment(startIdx+n_rho, n_mom) - pipe.mom_ref);
+    startIdx += n_rho + n_mom;
+    reduced_startIdx += pipe.n_state;
+  }
+
+  return reduced_state;
+}
+
+Eigen::VectorXd ReducedNetwork::lift(const Eigen::Ref<const Eigen::VectorXd>& reduced_state) const {
+  int n_full = 0;
+  for (const auto& pipe : pipes)
+    n_full += pipe.V_rho.rows() + pipe.V_mom.rows();
+
+  Eigen::VectorXd state(n_full);
+
+  int startIdx = 0, reduced_startIdx = 0;
+  for (const auto& pipe : pipes) {
+    const int n_rho = pipe.V_rho.rows();
+    const int n_mom = pipe.V_mom.rows();
+    state.segment(startIdx, n_rho) =
+      pipe.V_rho * reduced_state.segment(reduced_startIdx, pipe.n_rho) + pipe.rho_ref;
+    state.segment(startIdx+n_rho, n_mom) =
+      pipe.V_mom * reduced_state.segment(reduced_startIdx+pipe.n_rho, pipe.n_mom) + pipe.mom_ref;
+    startIdx += n_rho + n_mom;
+    reduced_startIdx += pipe.n_state;
+  }
+
+  return state;
+}
+
+ReducedNetwork reduce(
+  const DiscreteNetwork<double>& network,
+  const Eigen::Ref<const Eigen::MatrixXd>& snapshots,
+  const nlohmann::json& rom_params
+) {
+  for (const auto& pipe : network.pipes)
+    if (pipe.pressure_table)
+      throw std::invalid_argument("Reduced networks support only the ideal gas.");
+
+  const double tolerance = rom_params["tolerance"].get<double>();
+  const int max_rank     = rom_params["max_rank"].get<int>();
+  const int deim_rank    = rom_params["deim_rank"].get<int>();
+
+  ReducedNetwork rom;
+  for (const auto& compressor : network.compressors)
+    rom.compressors.push_back(compressor);
+  rom.n_state = 0;
+  rom.n_res = 0;
+
+  int startIdx = 0;
+  for (const auto& pipe : network.pipes) {
+    ReducedPipe rpipe;
+    rpipe.RT       = pipe.RT;
+    rpipe.friction = pipe.friction;
+    rpipe.diameter = pipe.diameter;
+
+    // POD bases of the deviation from the reference (first) snapshot
+    auto rho_snapshots = snapshots.middleRows(startIdx, pipe.n_rho);
+    auto mom_snapshots = snapshots.middleRows(startIdx+pipe.n_rho, pipe.n_mom);
+    rpipe.rho_ref = rho_snapshots.col(0);
+    rpipe.mom_ref = mom_snapshots.col(0);
+
+    rpipe.V_rho = pod_basis(rho_snapshots.colwise() - rpipe.rho_ref, tolerance, max_rank);
+    rpipe.V_mom = pod_basis(mom_snapshots.colwise() - rpipe.mom_ref, tolerance, max_rank);
+    rpipe.n_rho   = rpipe.V_rho.cols();
+    rpipe.n_mom   = rpipe.V_mom.cols();
+    rpipe.n_state = rpipe.n_rho + rpipe.n_mom;
+    rpipe.n_res   = rpipe.n_state + 2;
+
+    // Friction term snapshots for DEIM
+    Eigen::MatrixXd friction_snapshots(pipe.n_mom, snapshots.cols());
+    for (int j = 0; j < snapshots.cols(); ++j)
+      for (int i = 0; i < pipe.n_mom; ++i) {
+        const double rho = rho_snapshots(i, j);
+        const double mom = mom_snapshots(i, j);
+        friction_snapshots(i, j) = std::abs(rpipe.friction * mom/rho / (2 * rpipe.diameter)) * mom;
+      }
+
+    Eigen::MatrixXd U = pod_basis(friction_snapshots, tolerance, deim_rank);
+    rpipe.deim_nodes = deim_indices(U);
+
+    // V_mom^T U (P^T U)^{-1}
+    Eigen::MatrixXd PtU = U(rpipe.deim_nodes, Eigen::all);
+    rpipe.deim_projector = PtU.transpose().partialPivLu().solve(U.transpose() * rpipe.V_mom).transpose();
+
+    rpipe.V_rho_sampled   = rpipe.V_rho(rpipe.deim_nodes, Eigen::all);
+    rpipe.V_mom_sampled   = rpipe.V_mom(rpipe.deim_nodes, Eigen::all);
+    rpipe.rho_ref_sampled = rpipe.rho_ref(rpipe.deim_nodes);
+    rpipe.mom_ref_sampled = rpipe.mom_ref(rpipe.deim_nodes);
+
+    rom.n_state += rpipe.n_state;
+    rom.n_res   += rpipe.n_res;
+    startIdx    += pipe.n_state;
+    rom.pipes.push_back(rpipe);
+  }
+
+  // Trial basis V = diag(V_rho, V_mom), test basis W = diag(V_rho, V_mom, I_2)
+  Eigen::MatrixXd V = Eigen::MatrixXd::Zero(network.n_state, rom.n_state);
+  Eigen::MatrixXd W = Eigen::MatrixXd::Zero(network.n_res, rom.n_res);
+  Eigen::VectorXd effort_ref = Eigen::VectorXd::Zero(network.n_res);
+
+  int state_startIdx = 0, res_startIdx = 0;
+  int reduced_state_startIdx = 0, reduced_res_startIdx = 0;
+  for (int p = 0; p < network.pipes.size(); ++p) {
+    const auto& pipe  = network.pipes[p];
+    const auto& rpipe = rom.pipes[p];
+
+    V.block(state_startIdx, reduced_state_startIdx, pipe.n_rho, rpipe.n_rho) = rpipe.V_rho;
+    V.block(state_startIdx+pipe.n_rho, reduced_state_startIdx+rpipe.n_rho, pipe.n_mom, rpipe.n_mom) = rpipe.V_mom;
+
+    W.block(res_startIdx, reduced_res_startIdx, pipe.n_rho, rpipe.n_rho) = rpipe.V_rho;
+    W.block(res_startIdx+pipe.n_rho, reduced_res_startIdx+rpipe.n_rho, pipe.n_mom, rpipe.n_mom) = rpipe.V_mom;
+    W.block(res_startIdx+pipe.n_state, reduced_res_startIdx+rpipe.n_state, 2, 2).setIdentity();
+
+    effort_ref.segment(res_startIdx, pipe.n_rho) = rpipe.rho_ref * rpipe.RT;
+    effort_ref.segment(res_startIdx+pipe.n_rho, pipe.n_mom) = rpipe.mom_ref;
+
+    state_startIdx += pipe.n_state;
+    res_startIdx += pipe.n_res;
+    reduced_state_startIdx += rpipe.n_state;
+    reduced_res_startIdx += rpipe.n_res;
+  }
+
+  rom.E     = W.transpose() * (network.E * V);
+  rom.J     = W.transpose() * (network.J * W);
+  rom.J_ref = W.transpose() * (network.J * effort_ref);
+
+  return rom;
+}
+
+}
@@ -0,0 +1,245 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# include "server.hpp"
+# include "output.hpp"
+
+# include <algorithm>
+# include <cerrno>
+# include <cmath>
+# include <cstring>
+# include <stdexcept>
+# include <utility>
+# include <sys/socket.h>
+# include <sys/un.h>
+# include <unistd.h>
+
+namespace {
+  // Restores the boundary update of a simulator on scope exit, also when a step throws,
+  // such that no update referring to locals of a finished scenario remains installed
+  struct BoundaryUpdateGuard {
+      BoundaryUpdateGuard(phgasnets::Simulator& simulator) :
+        simulator(simulator), previous(simulator.boundary_update)
+      {}
+      ~BoundaryUpdateGuard() {
+        simulator.boundary_update = std::move(previous);
+      }
+
+      BoundaryUpdateGuard(const BoundaryUpdateGuard&) = delete;
+      BoundaryUpdateGuard& operator=(const BoundaryUpdateGuard&) = delete;
+
+      private:
+        phgasnets::Simulator& simulator;
+        decltype(phgasnets::Simulator::boundary_update) previous;
+  };
+}
+
+namespace phgasnets {
+
+BoundaryProfile::BoundaryProfile(const double value) :
+  times({0.0}), values({value})
+{}
+
+BoundaryProfile::BoundaryProfile(const nlohmann::json& profile) {
+  if (profile.is_number()) {
+    times  = {0.0};
+    values = {profile.get<double>()};
+    return;
+  }
+  for (const auto& point : profile) {
+    times.push_back(point.at(0).get<double>());
+    values.push_back(point.at(1).get<double>());
+  }
+  if (times.empty() || !std::is_sorted(times.begin(), times.end()))
+    throw std::invalid_argument("A boundary profile needs [time, value] pairs in increasing time.");
+}
+
+double BoundaryProfile::operator()(const double time) const {
+  if (time <= times.front())
+    return values.front();
+  if (time >= times.back())
+    return values.back();
+
+  const std::size_t k = std::upper_bound(times.begin(), times.end(), time) - times.begin();
+  const double w = (time - times[k-1]) / (times[k] - times[k-1]);
+  return (1.0-w)*values[k-1] + w*values[k];
+}
+
+nlohmann::json runScenario(
+  Simulator& simulator,
+  const Checkpoint& baseline,
+  const nlohmann::json& request
+) {
+  if (!request.contains("horizon"))
+    throw std::invalid_argument("A scenario needs a horizon.");
+
+  const double horizon = request["horizon"].get<double>();
+  const double dt      = request.value("step", baseline.timestep);
+  if (!(dt > 0.0) || !std::isfinite(dt))
+    throw std::invalid_argument("The time step size must be positive.");
+  if (!(horizon > 0.0) || !std::isfinite(horizon))
+    throw std::invalid_argument("The horizon must be positive.");
+
+  const auto& network    = simulator.discrete_network();
+  const auto& compressor = network.compressors[0];
+  const auto& inlet_pipe = network.pipes[0];
+
+  // Probes and frequency are checked before the simulator is touched
+  ProbeRecorder recorder(
+    network,
+    request.contains("probes") ? probesFromJson(request["probes"]) : std::vector<Probe>(),
+    request.value("frequency", 1)
+  );
+
+  // Start over from the baseline
+  simulator.initialize(baseline);
+  const double t0 = simulator.time();
+
+  const BoundaryProfile inlet_pressure = request.contains("inlet_pressure") ?
+    BoundaryProfile(request["inlet_pressure"]) : BoundaryProfile(baseline.input(0));
+  const BoundaryProfile outlet_momentum = request.contains("outlet_momentum") ?
+    BoundaryProfile(request["outlet_momentum"]) : BoundaryProfile(-baseline.input(3));
+
+  Eigen::Vector4d& input = simulator.input();
+  if (request.contains("specification")) {
+    const double specification = request["specification"].get<double>();
+    input(2) = specification;
+    if (compressor.model == "AV")
+      input(1) = 1.0/std::pow(specification, 1/compressor.isentropic_exponent);
+  }
+
+  recorder.record(0, 0.0, simulator.state());
+
+  const BoundaryUpdateGuard restore_update(simulator);
+  simulator.boundary_update = [&](double time, double dt, Eigen::Vector4d& u, Eigen::VectorXd& guess) {
+    const double t = time - t0;
+    guess(0)              = inlet_pipe.density(inlet_pressure(t));
+    guess(guess.size()-1) = outlet_momentum(t);
+
+    u(0) = inlet_pressure(t);
+    u(3) = -(outlet_momentum(t) + outlet_momentum(t-dt)) * 0.5;
+  };
+
+  int iterations = 0;
+  bool converged = true;
+  const int n_steps = std::ceil(horizon/dt - 1e-9);
+  for (int k = 1; k <= n_steps; ++k) {
+    const auto& summary = simulator.step(std::min(dt, t0 + horizon - simulator.time()));
+    iterations += summary.iterations.size();
+    converged  &= (summary.termination_type == ceres::CONVERGENCE);
+    recorder.record(k, simulator.time() - t0, simulator.state());
+  }
+
+  nlohmann::json result;
+  result["time"] = recorder.times();
+  result["probes"] = nlohmann::json::object();
+  for (std::size_t k = 0; k < recorder.probes.size(); ++k) {
+    result["probes"][recorder.probes[k].name] = {
+      {"pressure", recorder.pressure(k)},
+      {"momentum", recorder.momentum(k)}
+    };
+  }
+  result["iterations"] = iterations;
+  result["converged"]  = converged;
+
+  return result;
+}
+
+SimulationServer::SimulationServer(
+  const std::string& socket_path,
+  Handler handler
+) :
+  socket_path(socket_path),
+  handler(handler)
+{
+  sockaddr_un address = {};
+  address.sun_family = AF_UNIX;
+  if (socket_path.size() >= sizeof(address.sun_path))
+    throw std::runtime_error("Socket path " + socket_path + " is too long.");
+  std::strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path)-1);
+
+  listener = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listener < 0)
+    throw std::runtime_error("Cannot create socket: " + std::string(std::strerror(errno)));
+
+  unlink(socket_path.c_str());
+  if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, 8) != 0) {
+    const std::string error = std::strerror(errno);
+    close(listener);
+    throw std::runtime_error("Cannot listen on " + socket_path + ": " + error);
+  }
+}
+
+SimulationServer::~SimulationServer() {
+  close(listener);
+  unlink(socket_path.c_str());
+}
+
+void SimulationServer::run() {
+  while (true) {
+    const int connection = accept(listener, nullptr, nullptr);
+    if (connection < 0) {
+      if (errno == EINTR)
+        continue;
+      throw std::runtime_error("Cannot accept connection: " + std::string(std::strerror(errno)));
+    }
+
+    const bool keep_running = serve(connection);
+    close(connection);
+    if (!keep_running)
+      return;
+  }
+}
+
+bool SimulationServer::serve(const int connection) {
+  auto send_line = [connection](const nlohmann::json& response) {
+    const std::string line = response.dump() + "\n";
+    std::size_t sent = 0;
+    while (sent < line.size()) {
+      const ssize_t n = send(connection, line.data() + sent, line.size() - sent, MSG_NOSIGNAL);
+      if (n <= 0)
+        return false;
+      sent += n;
+    }
+    return true;
+  };
+
+  std::string buffer;
+  char chunk[4096];
+  while (true) {
+    const ssize_t n = recv(connection, chunk, sizeof(chunk), 0);
+    if (n <= 0)
+      return true;
+    buffer.append(chunk, n);
+
+    std::size_t end;
+    while ((end = buffer.find('\n')) != std::string::npos) {
+      const std::string line = buffer.substr(0, end);
+      buffer.erase(0, end+1);
+      if (line.find_first_not_of(" \t\r") == std::string::npos)
+        continue;
+
+      nlohmann::json response;
+      bool shutdown = false;
+      try {
+        const auto request = nlohmann::json::parse(line);
+        shutdown = (request.value("command", "") == "shutdown");
+        response = shutdown ? nlohmann::json::object() : handler(request);
+        response["status"] = "ok";
+      }
+      catch (const std::exception& error) {
+        response = {{"status", "error"}, {"message", error.what()}};
+      }
+
+      if (!send_line(response))
+        return !shutdown;
+      if (shutdown)
+        return false;
+    }
+  }
+}
+
+}
@@ -0,0 +1,178 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# include "simulator.hpp"
+# include "steady.hpp"
+# include "transient.hpp"
+# include "trace.hpp"
+# include "cache.hpp"
+
+# include <algorithm>
+# include <stdexcept>
+# include <string>
+
+namespace {
+  // Build default, numeric differentiation is central as in Ceres
+#if PHGASNETS_NUMERICDIFF
+  constexpr auto default_differentiation = phgasnets::Differentiation::CentralDifference;
+#else
+  constexpr auto default_differentiation = phgasnets::Differentiation::Automatic;
+#endif
+}
+
+namespace phgasnets {
+
+Differentiation differentiationFromString(const std::string& name) {
+  if (name == "automatic")
+    return Differentiation::Automatic;
+  if (name == "forward")
+    return Differentiation::ForwardDifference;
+  if (name == "central")
+    return Differentiation::CentralDifference;
+  throw std::invalid_argument("Unknown differentiation " + name + ", expected automatic, forward or central.");
+}
+
+std::string to_string(const Differentiation differentiation) {
+  switch (differentiation) {
+    case Differentiation::ForwardDifference: return "forward";
+    case Differentiation::CentralDifference: return "central";
+    default:                                 return "automatic";
+  }
+}
+
+Differentiation differentiationFromJson(const nlohmann::json& disc_params) {
+  return disc_params.contains("differentiation") ?
+    differentiationFromString(disc_params["differentiation"].get<std::string>()) : default_differentiation;
+}
+
+Simulator::Simulator(
+  const Network& network,
+  const nlohmann::json& disc_params
+) :
+  Simulator(network, disc_params, differentiationFromJson(disc_params))
+{}
+
+Simulator::Simulator(
+  const Network& network,
+  const nlohmann::json& disc_params,
+  const Differentiation differentiation
+) :
+  net(network),
+  disc_params(disc_params),
+  differentiation_mode(differentiation),
+  network(discretize<double>(network, disc_params["space"])),
+  input_vec(Eigen::Vector4d::Zero()),
+  current_time(disc_params["time"]["start"].get<double>()*3600),
+  timestep(disc_params["time"]["step"].get<double>()),
+  default_timestep(timestep),
+  current_step(0)
+{
+  current_state = Eigen::VectorXd::Zero(this->network.n_state);
+  guess         = Eigen::VectorXd::Zero(this->network.n_state);
+
+  options.function_tolerance = 1e-12;
+  options.max_num_iterations = 2000;
+  options.num_threads        = 1;
+
+  // The cost function reads current state, input and time step size by reference
+  auto system = new TransientCompressorSystem(net, disc_params, current_state, input_vec, current_time, timestep);
+  transient_system = system;
+  auto cost_function = differentiate(system, differentiation_mode);
+  cost_function->AddParameterBlock(this->network.n_state);
+  cost_function->SetNumResiduals(this->network.n_res);
+  problem.AddResidualBlock(cost_function, nullptr, guess.data());
+}
+
+const ceres::Solver::Summary& Simulator::initialize(const Eigen::Ref<const Eigen::VectorXd>& initial_guess) {
+  PHGASNETS_TRACE_SCOPE("steady_solve");
+  Eigen::VectorXd steady_state = initial_guess;
+
+  ceres::Problem problem_steady;
+  auto cost_function = differentiate(
+    new SteadyCompressorSystem(net, disc_params["space"], input_vec),
+    differentiation_mode, "steady_residual", "steady_jacobian"
+  );
+  cost_function->AddParameterBlock(network.n_state);
+  cost_function->SetNumResiduals(network.n_res);
+  problem_steady.AddResidualBlock(cost_function, nullptr, steady_state.data());
+
+  ceres::Solve(options, &problem_steady, &summary);
+
+  set_state(steady_state);
+  return summary;
+}
+
+void Simulator::initialize(const Checkpoint& checkpoint) {
+  // The buffers are bound to the cost function, a checkpoint of another network must not resize them
+  const std::string hash = network_hash(net, disc_params["space"]);
+  if (checkpoint.network_hash != hash)
+    throw std::invalid_argument("Checkpoint of network " + checkpoint.network_hash + " cannot resume network " + hash);
+  if (checkpoint.input.size() != input_vec.size())
+    throw std::invalid_argument("Checkpoint input of size " + std::to_string(checkpoint.input.size()) + " does not match the input of size " + std::to_string(input_vec.size()));
+
+  set_state(checkpoint.state);
+  input_vec    = checkpoint.input;
+  current_time = checkpoint.time;
+  current_step = checkpoint.step;
+  timestep     = checkpoint.timestep;
+  options.function_tolerance = checkpoint.function_tolerance;
+  options.max_num_iterations = checkpoint.max_num_iterations;
+}
+
+void Simulator::set_state(const Eigen::Ref<const Eigen::VectorXd>& state) {
+  if (state.size() != network.n_state)
+    throw std::invalid_argument("State of size " + std::to_string(state.size()) + " does not match the network state of size " + std::to_string(network.n_state));
+
+  // Assign in place, the cost function and problem refer to these buffers
+  current_state = state;
+  guess         = state;
+  network.set_state(current_state);
+}
+
+const ceres::Solver::Summary& Simulator::step(const double dt) {
+  PHGASNETS_TRACE_SCOPE("step");
+  timestep      = dt;
+  current_time += dt;
+
+  if (boundary_update)
+    boundary_update(current_time, dt, input_vec, guess);
+
+  {
+    PHGASNETS_TRACE_SCOPE("solve");
+    ceres::Solve(options, &problem, &summary);
+  }
+
+  current_state = guess;
+  network.set_state(current_state);
+  ++current_step;
+
+  return summary;
+}
+
+void Simulator::advance_to(const double end_time) {
+  const double eps = 1e-9 * default_timestep;
+  while (current_time < end_time - eps)
+    step(std::min(default_timestep, end_time - current_time));
+}
+
+MemoryFootprint Simulator::footprint() const {
+  MemoryFootprint memory;
+  memory.add("network", network.footprint());
+  memory.add("residual", transient_system->footprint());
+  memory.add("solver.state", allocatedBytes(current_state) + allocatedBytes(guess));
+  memory.add("solver.jacobian", std::size_t(network.n_res)*network.n_state*sizeof(double));
+  return memory;
+}
+
+Checkpoint Simulator::checkpoint() const {
+  return {
+    network_hash(net, disc_params["space"]),
+    current_state, input_vec, current_time, current_step, timestep,
+    options.function_tolerance, options.max_num_iterations
+  };
+}
+
+}
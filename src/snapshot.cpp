@@ -0,0 +1,224 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# include "snapshot.hpp"
+# include "cache.hpp"
+
+# include <cerrno>
+# include <cstdint>
+# include <cstring>
+# include <fstream>
+# include <stdexcept>
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+
+namespace {
+  // File layout, each section aligned to 8 bytes:
+  //   SnapshotHeader | PipeRecord[n_pipes] | CompressorRecord[n_compressors] | discretization json
+  //   | per pipe: MatrixRecord, outer, inner, values of Et, then of Jt
+  constexpr char snapshot_magic[8] = {'P', 'H', 'G', 'S', 'N', 'A', 'P', '\0'};
+  constexpr std::uint32_t snapshot_version = 2;
+
+  struct SnapshotHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t n_pipes;
+    std::uint32_t n_compressors;
+    std::uint32_t json_size;
+    std::int64_t resolution;
+    double gas_constant;
+    char hash[16];
+  };
+
+  struct PipeRecord {
+    double length, diameter, friction, temperature;
+  };
+
+  struct CompressorRecord {
+    char type[8], model[8];
+    double specification, compression_ratio, isentropic_exponent;
+  };
+
+  struct MatrixRecord {
+    std::int64_t rows, cols, nnz;
+  };
+
+  std::size_t aligned(const std::size_t bytes) {
+    return (bytes + 7) & ~std::size_t(7);
+  }
+
+  void write_aligned(std::ofstream& file, const void* data, const std::size_t bytes) {
+    static const char padding[8] = {};
+    file.write(static_cast<const char*>(data), bytes);
+    file.write(padding, aligned(bytes) - bytes);
+  }
+
+  void write_compressed(std::ofstream& file, Eigen::SparseMatrix<double> mat) {
+    mat.makeCompressed();
+    const MatrixRecord record = {mat.rows(), mat.cols(), mat.nonZeros()};
+    write_aligned(file, &record, sizeof(record));
+    write_aligned(file, mat.outerIndexPtr(), (mat.outerSize()+1)*sizeof(int));
+    write_aligned(file, mat.innerIndexPtr(), mat.nonZeros()*sizeof(int));
+    write_aligned(file, mat.valuePtr(), mat.nonZeros()*sizeof(double));
+  }
+
+  // Sections of the mapped file in order, checked against its size
+  struct Cursor {
+    const char* data;
+    std::size_t size, offset;
+    const std::string& filename;
+
+    const char* take(const std::size_t bytes) {
+      if (aligned(bytes) > size - offset)
+        throw std::runtime_error(filename + " is not a complete network snapshot.");
+      const char* section = data + offset;
+      offset += aligned(bytes);
+      return section;
+    }
+  };
+
+  Eigen::Map<const Eigen::SparseMatrix<double>> map_compressed(Cursor& cursor) {
+    const auto* record = reinterpret_cast<const MatrixRecord*>(cursor.take(sizeof(MatrixRecord)));
+    if (record->rows < 0 || record->cols < 0 || record->nnz < 0)
+      throw std::runtime_error(cursor.filename + " is not a valid network snapshot.");
+    const auto* outer  = reinterpret_cast<const int*>(cursor.take((record->cols+1)*sizeof(int)));
+    const auto* inner  = reinterpret_cast<const int*>(cursor.take(record->nnz*sizeof(int)));
+    const auto* values = reinterpret_cast<const double*>(cursor.take(record->nnz*sizeof(double)));
+    return Eigen::Map<const Eigen::SparseMatrix<double>>(record->rows, record->cols, record->nnz, outer, inner, values);
+  }
+}
+
+namespace phgasnets {
+
+void writeNetworkSnapshot(
+  const std::string& filename,
+  const Network& network,
+  const nlohmann::json& spatial_disc_params
+) {
+  auto discrete_network = discretize<double>(network, spatial_disc_params);
+
+  const std::string disc_json = spatial_disc_params.dump();
+  const std::string hash = network_hash(network, spatial_disc_params);
+
+  SnapshotHeader header = {};
+  std::memcpy(header.magic, snapshot_magic, sizeof(snapshot_magic));
+  header.version       = snapshot_version;
+  header.n_pipes       = network.pipes.size();
+  header.n_compressors = network.compressors.size();
+  header.json_size     = disc_json.size();
+  header.resolution    = spatial_disc_params["resolution"].get<int>();
+  header.gas_constant  = network.fluid.gas_constant;
+  std::memcpy(header.hash, hash.data(), std::min(hash.size(), sizeof(header.hash)));
+
+  std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+  if (!file.is_open())
+    throw std::runtime_error("Cannot open network snapshot " + filename);
+
+  write_aligned(file, &header, sizeof(header));
+  for (const auto& pipe : network.pipes) {
+    const PipeRecord record = {pipe.length, pipe.diameter, pipe.friction, pipe.temperature};
+    write_aligned(file, &record, sizeof(record));
+  }
+  for (const auto& compressor : network.compressors) {
+    CompressorRecord record = {};
+    std::strncpy(record.type, compressor.type.c_str(), sizeof(record.type)-1);
+    std::strncpy(record.model, compressor.model.c_str(), sizeof(record.model)-1);
+    record.specification       = compressor.specification;
+    record.compression_ratio   = compressor.compression_ratio;
+    record.isentropic_exponent = compressor.isentropic_exponent;
+    write_aligned(file, &record, sizeof(record));
+  }
+  write_aligned(file, disc_json.data(), disc_json.size());
+  for (const auto& pipe : discrete_network.pipes) {
+    write_compressed(file, pipe.Et.mat);
+    write_compressed(file, pipe.Jt.mat);
+  }
+
+  if (!file)
+    throw std::runtime_error("Cannot write network snapshot " + filename);
+}
+
+NetworkSnapshot::NetworkSnapshot(const std::string& filename) {
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("Cannot open network snapshot " + filename + ": " + std::strerror(errno));
+
+  struct stat info;
+  if (fstat(fd, &info) != 0) {
+    close(fd);
+    throw std::runtime_error("Cannot stat network snapshot " + filename + ": " + std::strerror(errno));
+  }
+  const std::size_t size = info.st_size;
+  if (size < sizeof(SnapshotHeader)) {
+    close(fd);
+    throw std::runtime_error(filename + " is not a valid network snapshot.");
+  }
+
+  void* memory = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (memory == MAP_FAILED)
+    throw std::runtime_error("Cannot map network snapshot " + filename + ": " + std::strerror(errno));
+
+  // Unmapped once neither the snapshot nor any network holds the operators
+  auto storage = std::shared_ptr<const void>(memory, [size](const void* memory) {
+    munmap(const_cast<void*>(memory), size);
+  });
+
+  Cursor cursor = {static_cast<const char*>(memory), size, 0, filename};
+  const auto* header = reinterpret_cast<const SnapshotHeader*>(cursor.take(sizeof(SnapshotHeader)));
+  if (std::memcmp(header->magic, snapshot_magic, sizeof(snapshot_magic)) != 0 || header->version != snapshot_version)
+    throw std::runtime_error(filename + " is not a valid network snapshot.");
+
+  hash         = std::string(header->hash, sizeof(header->hash));
+  gas_constant = header->gas_constant;
+
+  for (std::uint32_t p = 0; p < header->n_pipes; ++p) {
+    const auto* record = reinterpret_cast<const PipeRecord*>(cursor.take(sizeof(PipeRecord)));
+    pipes.push_back(Pipe(record->length, record->diameter, record->friction, record->temperature));
+  }
+  for (std::uint32_t c = 0; c < header->n_compressors; ++c) {
+    const auto* record = reinterpret_cast<const CompressorRecord*>(cursor.take(sizeof(CompressorRecord)));
+    compressors.push_back(Compressor(
+      std::string(record->type, strnlen(record->type, sizeof(record->type))),
+      std::string(record->model, strnlen(record->model, sizeof(record->model))),
+      record->specification, record->isentropic_exponent
+    ));
+    compressors.back().update_compression_ratio(record->compression_ratio);
+  }
+
+  const char* disc_json = cursor.take(header->json_size);
+  spatial_disc_params = nlohmann::json::parse(disc_json, disc_json + header->json_size);
+
+  auto static_operators = std::make_shared<StaticOperators>();
+  static_operators->resolution = header->resolution;
+  for (std::uint32_t p = 0; p < header->n_pipes; ++p) {
+    const auto Et = map_compressed(cursor);
+    const auto Jt = map_compressed(cursor);
+    static_operators->pipes.push_back(StaticPipeOperators{Et, Jt});
+  }
+  static_operators->storage = storage;
+  operators = static_operators;
+}
+
+Network NetworkSnapshot::network() {
+  return network(Fluid(gas_constant));
+}
+
+Network NetworkSnapshot::network(const Fluid& fluid) {
+  Network restored(pipes, compressors, fluid);
+  adoptOperators(restored);
+  return restored;
+}
+
+void NetworkSnapshot::adoptOperators(Network& network) const {
+  if (network_hash(network, spatial_disc_params) != hash)
+    throw std::invalid_argument("The network snapshot was written for another network, with hash " + hash + ".");
+  network.operators = operators;
+}
+
+}
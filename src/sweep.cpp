@@ -0,0 +1,213 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# include "sweep.hpp"
+# include "server.hpp"
+
+# include <algorithm>
+# include <atomic>
+# include <cmath>
+# include <exception>
+# include <limits>
+# include <numeric>
+# include <stdexcept>
+# include <string>
+# include <thread>
+# include <time.h>
+
+namespace {
+  // CPU time of the calling thread, which unlike wall time is unaffected by runs in parallel
+  double thread_cpu_time() {
+    timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return now.tv_sec + 1e-9*now.tv_nsec;
+  }
+
+  // Outlet time series of a scenario run
+  struct SweepRun {
+    phgasnets::SweepResult result;
+    std::vector<double> time, pressure, momentum;
+  };
+
+  SweepRun runSetting(
+    const phgasnets::Network& network,
+    const nlohmann::json& disc_params,
+    const Eigen::Vector4d& input,
+    const nlohmann::json& scenario,
+    const phgasnets::SweepPoint& point
+  ) {
+    nlohmann::json disc = disc_params;
+    disc["space"]["resolution"] = point.resolution;
+    disc["time"]["step"]        = point.timestep;
+
+    phgasnets::Simulator simulator(network, disc);
+    simulator.input() = input;
+    const auto& steady = simulator.initialize(phgasnets::steadyStateGuess(network, point.resolution, input(0), -input(3)));
+    const ceres::TerminationType steady_termination = steady.termination_type;
+    const phgasnets::Checkpoint baseline = simulator.checkpoint();
+
+    nlohmann::json request = scenario;
+    request["step"]      = point.timestep;
+    request["frequency"] = 1;
+    request["probes"]    = {{
+      {"name", "outlet"}, {"pipe", network.pipes.size()-1}, {"position", network.pipes.back().length}
+    }};
+
+    // The scenario runs on this thread, with a single threaded solver
+    const double start = thread_cpu_time();
+    const nlohmann::json outcome = phgasnets::runScenario(simulator, baseline, request);
+    const double runtime = thread_cpu_time() - start;
+
+    SweepRun run;
+    run.result   = {
+      point.resolution, point.timestep, runtime, outcome["iterations"],
+      ceres::TerminationTypeToString(steady_termination),
+      steady_termination == ceres::CONVERGENCE && outcome["converged"].get<bool>(),
+      0.0, 0.0, false
+    };
+    run.time     = outcome["time"].get<std::vector<double>>();
+    run.pressure = outcome["probes"]["outlet"]["pressure"].get<std::vector<double>>();
+    run.momentum = outcome["probes"]["outlet"]["momentum"].get<std::vector<double>>();
+    return run;
+  }
+
+  // Linear interpolation in a time series, constant beyond its ends
+  double interpolate(const std::vector<double>& times, const std::vector<double>& values, const double time) {
+    if (time <= times.front())
+      return values.front();
+    if (time >= times.back())
+      return values.back();
+    const std::size_t k = std::upper_bound(times.begin(), times.end(), time) - times.begin();
+    const double w = (time - times[k-1]) / (times[k] - times[k-1]);
+    return (1.0-w)*values[k-1] + w*values[k];
+  }
+
+  // Largest deviation of a series from the reference, relative to the largest reference value
+  double relativeError(
+    const std::vector<double>& times, const std::vector<double>& values,
+    const std::vector<double>& reference_times, const std::vector<double>& reference_values
+  ) {
+    double scale = 0.0, error = 0.0;
+    for (const double value : reference_values)
+      scale = std::max(scale, std::abs(value));
+    for (std::size_t k = 0; k < times.size(); ++k)
+      error = std::max(error, std::abs(values[k] - interpolate(reference_times, reference_values, times[k])));
+    return scale > 0.0 ? error/scale : error;
+  }
+}
+
+namespace phgasnets {
+
+nlohmann::json SweepResult::to_json() const {
+  return {
+    {"resolution", resolution},
+    {"timestep", timestep},
+    {"runtime", runtime},
+    {"iterations", iterations},
+    {"steady_termination", steady_termination},
+    {"converged", converged},
+    {"pressure_error", pressure_error},
+    {"momentum_error", momentum_error},
+    {"pareto", pareto}
+  };
+}
+
+Eigen::VectorXd steadyStateGuess(
+  const Network& network,
+  const int resolution,
+  const double inlet_pressure,
+  const double outlet_momentum
+) {
+  const int n_pipes = network.pipes.size();
+  const int n_state = 2*resolution+2;
+
+  // Momentum upstream of a compressor is scaled back from the downstream one
+  std::vector<double> momentum(n_pipes, outlet_momentum);
+  for (int k = n_pipes-2; k >= 0; --k)
+    momentum[k] = momentum[k+1]/network.compressors[k].momentum_scale;
+
+  Eigen::VectorXd state(n_pipes*n_state);
+  double pressure = inlet_pressure;
+  for (int k = 0; k < n_pipes; ++k) {
+    if (k > 0)
+      pressure *= network.compressors[k-1].compression_ratio;
+    state.segment(k*n_state, resolution+1).setConstant(network.fluid.density(pressure, network.pipes[k].temperature));
+    state.segment(k*n_state+resolution+1, resolution+1).setConstant(momentum[k]);
+  }
+  return state;
+}
+
+std::vector<SweepResult> sweepDiscretizations(
+  const Network& network,
+  const nlohmann::json& disc_params,
+  const Eigen::Vector4d& input,
+  const nlohmann::json& scenario,
+  const std::vector<SweepPoint>& grid,
+  const SweepPoint& reference,
+  const int threads
+) {
+  // The reference runs alongside the grid, as the last setting
+  std::vector<SweepPoint> points = grid;
+  points.push_back(reference);
+  std::vector<SweepRun> runs(points.size());
+
+  std::atomic<std::size_t> next(0);
+  std::exception_ptr failure;
+  std::atomic<bool> failed(false);
+  auto worker = [&]() {
+    for (std::size_t k = next++; k < points.size() && !failed; k = next++) {
+      try {
+        runs[k] = runSetting(network, disc_params, input, scenario, points[k]);
+      }
+      catch (...) {
+        if (!failed.exchange(true))
+          failure = std::current_exception();
+      }
+    }
+  };
+
+  std::vector<std::thread> pool;
+  for (int t = 1; t < std::min<int>(threads, points.size()); ++t)
+    pool.emplace_back(worker);
+  worker();
+  for (auto& thread : pool)
+    thread.join();
+  if (failure)
+    std::rethrow_exception(failure);
+
+  const SweepRun& fine = runs.back();
+  if (fine.result.steady_termination != ceres::TerminationTypeToString(ceres::CONVERGENCE))
+    throw std::runtime_error("The steady state of the reference run of the sweep did not converge: " + fine.result.steady_termination + ".");
+  if (!fine.result.converged)
+    throw std::runtime_error("The reference run of the sweep did not converge.");
+
+  std::vector<SweepResult> results;
+  for (std::size_t k = 0; k < grid.size(); ++k) {
+    SweepResult result = runs[k].result;
+    result.pressure_error = relativeError(runs[k].time, runs[k].pressure, fine.time, fine.pressure);
+    result.momentum_error = relativeError(runs[k].time, runs[k].momentum, fine.time, fine.momentum);
+    results.push_back(result);
+  }
+
+  // Pareto front of runtime against the larger of both errors, among converged settings
+  std::vector<std::size_t> order(results.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&results](std::size_t a, std::size_t b) {
+    return results[a].runtime < results[b].runtime;
+  });
+  double best_error = std::numeric_limits<double>::infinity();
+  for (const std::size_t k : order) {
+    if (!results[k].converged)
+      continue;
+    const double error = std::max(results[k].pressure_error, results[k].momentum_error);
+    results[k].pareto = error < best_error;
+    best_error = std::min(best_error, error);
+  }
+
+  return results;
+}
+
+}
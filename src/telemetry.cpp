@@ -0,0 +1,142 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# include "telemetry.hpp"
+
+# include <algorithm>
+# include <fstream>
+# include <stdexcept>
+# include <vector>
+
+namespace phgasnets {
+
+nlohmann::json StepTelemetry::to_json() const {
+  return {
+    {"step", step},
+    {"time", time},
+    {"dt", dt},
+    {"iterations", iterations},
+    {"residual_evaluations", residual_evaluations},
+    {"jacobian_evaluations", jacobian_evaluations},
+    {"solver_time", solver_time},
+    {"residual_time", residual_time},
+    {"jacobian_time", jacobian_time},
+    {"linear_solver_time", linear_solver_time},
+    {"io_wait_time", io_wait_time},
+    {"final_cost", final_cost},
+    {"termination", termination}
+  };
+}
+
+SolverTelemetry::SolverTelemetry(
+  const std::string& filename,
+  const bool append
+) :
+  filename(filename)
+{
+  if (filename.empty())
+    return;
+
+  file.open(filename, append ? std::ios::app : std::ios::trunc);
+  if (!file.is_open())
+    throw std::runtime_error("Cannot open telemetry file " + filename);
+}
+
+const StepTelemetry& SolverTelemetry::record(
+  const int step,
+  const double time,
+  const double dt,
+  const ceres::Solver::Summary& summary,
+  const double io_wait_time
+) {
+  last = {
+    step, time, dt,
+    static_cast<int>(summary.iterations.size()),
+    summary.num_residual_evaluations,
+    summary.num_jacobian_evaluations,
+    summary.total_time_in_seconds,
+    summary.residual_evaluation_time_in_seconds,
+    summary.jacobian_evaluation_time_in_seconds,
+    summary.linear_solver_time_in_seconds,
+    io_wait_time,
+    summary.final_cost,
+    ceres::TerminationTypeToString(summary.termination_type)
+  };
+
+  iterations.add(last.iterations);
+  solver_time          += last.solver_time;
+  residual_time        += last.residual_time;
+  jacobian_time        += last.jacobian_time;
+  linear_solver_time   += last.linear_solver_time;
+  this->io_wait_time   += io_wait_time;
+  residual_evaluations += last.residual_evaluations;
+  jacobian_evaluations += last.jacobian_evaluations;
+  if (summary.termination_type != ceres::CONVERGENCE)
+    unconverged_steps.push_back(step);
+
+  // Keep the most expensive steps only
+  auto more_expensive = [](const StepTelemetry& a, const StepTelemetry& b) {
+    return a.iterations != b.iterations ? a.iterations > b.iterations : a.solver_time > b.solver_time;
+  };
+  if (slowest.size() < max_slowest || more_expensive(last, slowest.back())) {
+    slowest.insert(std::upper_bound(slowest.begin(), slowest.end(), last, more_expensive), last);
+    if (slowest.size() > max_slowest)
+      slowest.pop_back();
+  }
+
+  if (file.is_open())
+    file << last.to_json().dump() << '\n';
+
+  return last;
+}
+
+void SolverTelemetry::discardAfter(const int step) {
+  if (filename.empty())
+    return;
+
+  file.close();
+  std::vector<std::string> kept;
+  {
+    std::ifstream input(filename);
+    std::string line;
+    while (std::getline(input, line)) {
+      const auto record = nlohmann::json::parse(line, nullptr, false);
+      if (!record.is_discarded() && record.contains("step") && record["step"].get<int>() <= step)
+        kept.push_back(line);
+    }
+  }
+
+  file.open(filename, std::ios::trunc);
+  if (!file.is_open())
+    throw std::runtime_error("Cannot open telemetry file " + filename);
+  for (const auto& line : kept)
+    file << line << '\n';
+  file.flush();
+  if (!file)
+    throw std::runtime_error("Cannot rewrite telemetry file " + filename);
+}
+
+nlohmann::json SolverTelemetry::to_json(const std::size_t n_slowest) const {
+  nlohmann::json slowest_steps = nlohmann::json::array();
+  for (std::size_t k = 0; k < std::min(n_slowest, slowest.size()); ++k)
+    slowest_steps.push_back(slowest[k].to_json());
+
+  return {
+    {"steps", iterations.count},
+    {"iterations", iterations.to_json()},
+    {"residual_evaluations", residual_evaluations},
+    {"jacobian_evaluations", jacobian_evaluations},
+    {"solver_time", solver_time},
+    {"residual_time", residual_time},
+    {"jacobian_time", jacobian_time},
+    {"linear_solver_time", linear_solver_time},
+    {"io_wait_time", io_wait_time},
+    {"unconverged_steps", unconverged_steps},
+    {"slowest_steps", slowest_steps}
+  };
+}
+
+}
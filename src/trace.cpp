@@ -0,0 +1,104 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+# include "trace.hpp"
+
+# include <atomic>
+# include <cstdio>
+# include <memory>
+# include <mutex>
+# include <stdexcept>
+# include <vector>
+
+namespace {
+  struct TraceEvent {
+    const char* name;
+    std::chrono::steady_clock::time_point start, end;
+  };
+
+  // Events of one thread, locked only against the final write out
+  struct ThreadEvents {
+    int tid;
+    std::mutex mutex;
+    std::vector<TraceEvent> events;
+  };
+
+  std::atomic<bool> enabled{false};
+  std::chrono::steady_clock::time_point origin;
+
+  std::mutex registry_mutex;
+  std::vector<std::shared_ptr<ThreadEvents>> registry;
+
+  ThreadEvents& thread_events() {
+    thread_local std::shared_ptr<ThreadEvents> events = [] {
+      std::lock_guard<std::mutex> lock(registry_mutex);
+      auto thread = std::make_shared<ThreadEvents>();
+      thread->tid = registry.size() + 1;
+      thread->events.reserve(1 << 14);
+      registry.push_back(thread);
+      return thread;
+    }();
+    return *events;
+  }
+
+  double microseconds(const std::chrono::steady_clock::time_point time) {
+    return std::chrono::duration<double, std::micro>(time - origin).count();
+  }
+}
+
+namespace phgasnets {
+
+void startTracing() {
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  for (auto& thread : registry) {
+    std::lock_guard<std::mutex> thread_lock(thread->mutex);
+    thread->events.clear();
+  }
+  origin = std::chrono::steady_clock::now();
+  enabled.store(true, std::memory_order_release);
+}
+
+void stopTracing(const std::string& filename) {
+  enabled.store(false, std::memory_order_release);
+
+  std::unique_ptr<std::FILE, int(*)(std::FILE*)> file(std::fopen(filename.c_str(), "w"), &std::fclose);
+  if (!file)
+    throw std::runtime_error("Cannot open trace file " + filename);
+
+  std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", file.get());
+  bool first = true;
+
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  for (auto& thread : registry) {
+    std::lock_guard<std::mutex> thread_lock(thread->mutex);
+    for (const auto& event : thread->events) {
+      std::fprintf(file.get(), "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+        first ? "" : ",\n", event.name, thread->tid, microseconds(event.start),
+        std::chrono::duration<double, std::micro>(event.end - event.start).count());
+      first = false;
+    }
+    thread->events.clear();
+  }
+  std::fputs("\n]}\n", file.get());
+
+  if (std::ferror(file.get()))
+    throw std::runtime_error("Cannot write trace file " + filename);
+}
+
+bool tracing() {
+  return enabled.load(std::memory_order_relaxed);
+}
+
+TraceScope::~TraceScope() {
+  if (!name)
+    return;
+  const auto end = std::chrono::steady_clock::now();
+  auto& thread = thread_events();
+  std::lock_guard<std::mutex> lock(thread.mutex);
+  thread.events.push_back({name, start, end});
+}
+
+}
@@ -5,8 +5,20 @@
 // SPDX-License-Identifier:  GPL-3.0-or-later
 
 # include "utils.hpp"
+# include <algorithm>
+# include <charconv>
 # include <fstream>
-# include <iomanip>
+# include <iostream>
+# include <stdexcept>
+
+namespace {
+    // Longest formatted double, e.g. "-1.234567e+308", and its delimiter
+    constexpr std::size_t max_value_length = 16;
+
+    std::size_t max_row_length(const std::size_t num_columns) {
+        return num_columns * max_value_length;
+    }
+}
 
 Eigen::VectorXd phgasnets::verticallyBlockVectors(
     const std::vector<Eigen::VectorXd>& vectors
@@ -48,29 +60,85 @@ void phgasnets::writeColumnsToCSV(
             return;
         }
     }
-    // Open File
-    std::ofstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Cannot open file.\n";
-        return;
+    // Write rows through the streaming writer
+    try {
+        CSVWriter writer(filename, column_names);
+        std::vector<double> row(num_columns);
+        for (size_t i = 0; i < num_rows; ++i) {
+            for (size_t j = 0; j < num_columns; ++j)
+                row[j] = columns[j][i];
+            writer.writeRow(row.data());
+        }
     }
+    catch (const std::runtime_error& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+    }
+}
+
+phgasnets::CSVWriter::CSVWriter(
+    const std::string& filename,
+    const std::vector<std::string>& column_names,
+    const std::size_t buffer_size
+) :
+    num_columns(column_names.size()),
+    filename(filename),
+    file(filename, std::ios::binary),
+    buffer(std::max<std::size_t>(buffer_size, max_row_length(column_names.size()))),
+    used(0)
+{
+    if (!file.is_open())
+        throw std::runtime_error("Cannot open file " + filename);
+
     // Write column headers
-    file << std::scientific << std::setprecision(6);
     for (size_t i = 0; i < column_names.size(); ++i) {
         file << column_names[i];
         if (i < column_names.size() - 1)
           file << " ";
     }
     file << "\n";
+    if (!file)
+        throw std::runtime_error("Cannot write to file " + filename);
+}
+
+phgasnets::CSVWriter::~CSVWriter() {
+    // Destructors must not throw, report what flush() would have thrown. A failed stream
+    // without pending rows has been reported by the throwing call already.
+    try {
+        if (used > 0 || file)
+            flush();
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+    }
+}
+
+void phgasnets::CSVWriter::writeRow(const double* values) {
+    if (buffer.size() - used < max_row_length(num_columns))
+        flush();
 
-    for (size_t i = 0; i < num_rows; ++i) {
-      for (size_t j = 0; j < num_columns; ++j) {
-          file << columns[j][i];
-          if (j < num_columns - 1)
-              file << " ";
-      }
-      file << "\n";
+    char* first = buffer.data() + used;
+    char* const last = buffer.data() + buffer.size();
+    for (size_t j = 0; j < num_columns; ++j) {
+        first = std::to_chars(first, last, values[j], std::chars_format::scientific, 6).ptr;
+        *first++ = (j < num_columns - 1) ? ' ' : '\n';
     }
+    used = first - buffer.data();
+}
+
+void phgasnets::CSVWriter::writeRow(std::initializer_list<double> values) {
+    if (values.size() != num_columns)
+        throw std::invalid_argument("Row size does not match the number of columns.");
+    writeRow(values.begin());
+}
 
-    file.close();
+void phgasnets::CSVWriter::flush() {
+    // A failed write leaves the stream failed, such that later rows are not silently dropped either
+    const std::size_t n = used;
+    used = 0;
+    if (!file)
+        throw std::runtime_error("Cannot write to file " + filename);
+    file.write(buffer.data(), n);
+    file.flush();
+    if (!file)
+        throw std::runtime_error("Cannot write to file " + filename);
 }
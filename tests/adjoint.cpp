@@ -0,0 +1,165 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+// Compares the adjoint gradients of TransientAdjoint against central finite differences.
+//
+// On the two-pipe FC/AV network, a short transient is driven by a rising outlet momentum from
+// its steady state. The objective is the sum of the outlet pressures of the second pipe over
+// all time steps. Its gradients with respect to the inputs of every step and the friction
+// factors of both pipes have to match central differences of forward runs to a relative
+// tolerance of 1e-3 per entry. The differences themselves are accurate to about 1e-5.
+
+# include <phgasnets>
+
+# include <cmath>
+# include <cstdio>
+# include <vector>
+
+namespace {
+  const double inlet_temperature = 276.25, inlet_pressure = 8e6;
+  const double gas_constant = 530.0;
+  const int Nx = 8, n_steps = 6;
+  const double tolerance = 1e-3;
+
+  const nlohmann::json disc_params = {
+    {"space", {{"resolution", Nx}, {"order", 1}}},
+    {"time", {{"start", 0}, {"end", 1}, {"step", 600}}}
+  };
+
+  // The two-pipe network with the given friction factors
+  struct TwoPipes {
+      TwoPipes(const float friction_left, const float friction_right) :
+        compressors({phgasnets::Compressor("FC", "AV", 1.2, 1.4)}),
+        pipes({
+          phgasnets::Pipe(181500, 1.422, friction_left, inlet_temperature),
+          phgasnets::Pipe(181500, 1.422, friction_right, inlet_temperature*compressors[0].temperature_scale)
+        }),
+        network(pipes, compressors, phgasnets::Fluid(gas_constant))
+      {
+        compressors[0].update_compression_ratio(1.2);
+      }
+
+      std::vector<phgasnets::Compressor> compressors;
+      std::vector<phgasnets::Pipe> pipes;
+      phgasnets::Network network;
+  };
+
+  // Tight tolerances, such that differences of forward runs resolve the gradient
+  void tighten(phgasnets::Simulator& simulator) {
+    simulator.options.function_tolerance  = 1e-16;
+    simulator.options.gradient_tolerance  = 1e-16;
+    simulator.options.parameter_tolerance = 1e-14;
+  }
+
+  // States of a forward run from the initial state, one per step including the initial one
+  std::vector<Eigen::VectorXd> forward(
+    const float friction_left, const float friction_right,
+    const Eigen::VectorXd& initial_state,
+    const std::vector<Eigen::Vector4d>& inputs
+  ) {
+    TwoPipes net(friction_left, friction_right);
+    phgasnets::Simulator simulator(net.network, disc_params);
+    tighten(simulator);
+    simulator.set_state(initial_state);
+    simulator.boundary_update = [&](double, double, Eigen::Vector4d& u, Eigen::VectorXd&) {
+      u = inputs[simulator.step_count()];
+    };
+
+    std::vector<Eigen::VectorXd> states = {initial_state};
+    for (int n = 0; n < n_steps; ++n) {
+      simulator.step(disc_params["time"]["step"].get<double>());
+      states.push_back(simulator.state());
+    }
+    return states;
+  }
+
+  double objective(const std::vector<Eigen::VectorXd>& states, const Eigen::VectorXd& weights) {
+    double value = 0.0;
+    for (const auto& state : states)
+      value += weights.dot(state);
+    return value;
+  }
+
+  int failures = 0;
+
+  void compare(const char* what, const double adjoint, const double difference) {
+    const double error = std::abs(adjoint - difference)/std::abs(difference);
+    std::printf("%-28s adjoint % .10e  difference % .10e  error %.2e\n", what, adjoint, difference, error);
+    if (!(error <= tolerance)) {
+      std::printf("  FAILED: exceeds %.0e\n", tolerance);
+      ++failures;
+    }
+  }
+}
+
+int main() {
+  const float friction = 1.8e-3f;
+  TwoPipes nominal(friction, friction);
+
+  // Steady state at the initial input
+  const double mom0 = 463.33;
+  const double coupling = 1.0/std::pow(1.2, 1/1.4);
+  phgasnets::Simulator steady(nominal.network, disc_params);
+  tighten(steady);
+  steady.input() = Eigen::Vector4d(inlet_pressure, coupling, 1.2, -mom0);
+  Eigen::VectorXd guess(4*(Nx+1));
+  guess.segment(0, Nx+1).setConstant(inlet_pressure/nominal.network.RT(0));
+  guess.segment(Nx+1, Nx+1).setConstant(mom0/nominal.compressors[0].momentum_scale);
+  guess.segment(2*(Nx+1), Nx+1).setConstant(1.2*inlet_pressure/nominal.network.RT(1));
+  guess.segment(3*(Nx+1), Nx+1).setConstant(mom0);
+  steady.initialize(guess);
+  const Eigen::VectorXd initial_state = steady.state();
+
+  // Outlet momentum rising by 10% over the run
+  std::vector<Eigen::Vector4d> inputs;
+  for (int n = 0; n < n_steps; ++n)
+    inputs.push_back(Eigen::Vector4d(inlet_pressure, coupling, 1.2, -mom0*(1.0 + 0.1*(n+1)/n_steps)));
+
+  const Eigen::VectorXd weights = phgasnets::pressure_sensitivity(steady.discrete_network(), 1, Nx);
+
+  // Adjoint gradients of the nominal run
+  const auto states = forward(friction, friction, initial_state, inputs);
+  phgasnets::TransientAdjoint adjoint(nominal.network, disc_params);
+  adjoint.record_initial_state(states[0]);
+  for (int n = 0; n < n_steps; ++n)
+    adjoint.record(inputs[n], states[n+1]);
+  const auto gradient = adjoint.gradient(std::vector<Eigen::VectorXd>(n_steps+1, weights));
+
+  // Inputs: inlet pressure, coupling factor, specification and outlet momentum of every step
+  for (int n = 0; n < n_steps; ++n) {
+    for (int k = 0; k < 4; ++k) {
+      const double h = 1e-5*std::abs(inputs[n](k));
+      auto plus = inputs, minus = inputs;
+      plus[n](k)  += h;
+      minus[n](k) -= h;
+      const double difference = (
+        objective(forward(friction, friction, initial_state, plus), weights)
+        - objective(forward(friction, friction, initial_state, minus), weights)
+      ) / (2*h);
+
+      char what[32];
+      std::snprintf(what, sizeof(what), "dJ/du[%d](%d)", n, k);
+      compare(what, gradient.inputs[n](k), difference);
+    }
+  }
+
+  // Friction factors, perturbed by the float steps they are stored in
+  for (int p = 0; p < 2; ++p) {
+    const float plus = friction*1.001f, minus = friction*0.999f;
+    const double difference = (
+      objective(forward(p == 0 ? plus : friction, p == 1 ? plus : friction, initial_state, inputs), weights)
+      - objective(forward(p == 0 ? minus : friction, p == 1 ? minus : friction, initial_state, inputs), weights)
+    ) / (double(plus) - double(minus));
+
+    char what[32];
+    std::snprintf(what, sizeof(what), "dJ/df[%d]", p);
+    compare(what, gradient.friction(p), difference);
+  }
+
+  if (failures > 0)
+    std::printf("%d gradient checks failed\n", failures);
+  return failures > 0 ? 1 : 0;
+}
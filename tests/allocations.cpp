@@ -0,0 +1,125 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+// Fails if a residual or Jacobian evaluation of the steady or transient system allocates on the heap.
+//
+// The residual functors are checked directly, with double scalars and with Jets over every
+// derivative pass of a Jacobian, and must not allocate at all once set up. Through Ceres, the
+// DynamicAutoDiffCostFunction allocates its Jet input and output buffers on every Evaluate call.
+// Those are excluded by requiring the count of a Jacobian evaluation to be independent of the
+// resolution, i.e. not to grow with the number of derivative passes.
+// The nonlinear solve itself (dense QR, trust region) is not checked.
+
+# include "fixture.hpp"
+# include "allocations.hpp"
+
+# include <cstdio>
+# include <string>
+# include <ceres/ceres.h>
+
+using phgasnets::benchmarks::BenchmarkNetwork;
+using phgasnets::benchmarks::count_allocations;
+
+namespace {
+  // Jet size of the dynamic autodiff cost function of the simulator
+  constexpr int stride = 4;
+  using Jet = ceres::Jet<double, stride>;
+
+  int failures = 0;
+
+  void expect_none(const char* what, const int Nx, const std::uint64_t allocations) {
+    std::printf("%-40s Nx = %5d: %llu allocations\n", what, Nx, static_cast<unsigned long long>(allocations));
+    if (allocations > 0) {
+      std::printf("  FAILED: expected none\n");
+      ++failures;
+    }
+  }
+
+  // Residual evaluations with double scalars, and with Jets over all derivative passes
+  template <typename Functor>
+  void check_functor(const char* name, const Functor& functor, const Eigen::VectorXd& state, const int n_res) {
+    const int n_state = state.size();
+    const int Nx = n_state/4 - 1;
+
+    std::vector<double> residual(n_res);
+    const double* parameters = state.data();
+    functor(&parameters, residual.data());
+    expect_none((std::string(name) + " residual<double>").c_str(), Nx,
+      count_allocations([&] { functor(&parameters, residual.data()); }));
+
+    std::vector<Jet> guess(n_state), jet_residual(n_res);
+    for (int i = 0; i < n_state; ++i)
+      guess[i] = Jet(state(i));
+    const Jet* jet_parameters = guess.data();
+    functor(&jet_parameters, jet_residual.data());
+
+    expect_none((std::string(name) + " residual<Jet>, all passes").c_str(), Nx, count_allocations([&] {
+      for (int start = 0; start < n_state; start += stride) {
+        for (int i = 0; i < n_state; ++i)
+          guess[i].v.setZero();
+        for (int k = 0; k < stride && start+k < n_state; ++k)
+          guess[start+k].v[k] = 1.0;
+        functor(&jet_parameters, jet_residual.data());
+      }
+    }));
+  }
+
+  // Allocations of one residual and Jacobian evaluation through the cost function of the simulator
+  template <typename Functor>
+  std::uint64_t cost_function_allocations(Functor* functor, const Eigen::VectorXd& state, const int n_res) {
+    const int n_state = state.size();
+    ceres::DynamicAutoDiffCostFunction<Functor, stride> cost_function(functor);
+    cost_function.AddParameterBlock(n_state);
+    cost_function.SetNumResiduals(n_res);
+
+    std::vector<double> residual(n_res), jacobian(std::size_t(n_res)*n_state);
+    const double* parameters = state.data();
+    double* jacobians = jacobian.data();
+    cost_function.Evaluate(&parameters, residual.data(), &jacobians);
+    return count_allocations([&] { cost_function.Evaluate(&parameters, residual.data(), &jacobians); });
+  }
+}
+
+int main() {
+  const double time = 0.0, dt = 100.0;
+  std::uint64_t ceres_allocations[2][2];
+
+  const int resolutions[] = {16, 128};
+  for (int k = 0; k < 2; ++k) {
+    const int Nx = resolutions[k];
+    BenchmarkNetwork bench(Nx);
+    const int n_res = bench.state.size()+4;
+
+    phgasnets::SteadyCompressorSystem steady(bench.network, bench.disc_params["space"], bench.input);
+    check_functor("steady", steady, bench.state, n_res);
+
+    phgasnets::TransientCompressorSystem transient(bench.network, bench.disc_params, bench.state, bench.input, time, dt);
+    check_functor("transient", transient, bench.state, n_res);
+
+    ceres_allocations[k][0] = cost_function_allocations(
+      new phgasnets::SteadyCompressorSystem(bench.network, bench.disc_params["space"], bench.input), bench.state, n_res
+    );
+    ceres_allocations[k][1] = cost_function_allocations(
+      new phgasnets::TransientCompressorSystem(bench.network, bench.disc_params, bench.state, bench.input, time, dt), bench.state, n_res
+    );
+  }
+
+  const char* systems[] = {"steady", "transient"};
+  for (int s = 0; s < 2; ++s) {
+    std::printf("%-40s Nx = %d: %llu, Nx = %d: %llu allocations in Ceres\n",
+      (std::string(systems[s]) + " residual and Jacobian").c_str(),
+      resolutions[0], static_cast<unsigned long long>(ceres_allocations[0][s]),
+      resolutions[1], static_cast<unsigned long long>(ceres_allocations[1][s]));
+    if (ceres_allocations[0][s] != ceres_allocations[1][s]) {
+      std::printf("  FAILED: allocations grow with the resolution\n");
+      ++failures;
+    }
+  }
+
+  if (failures > 0)
+    std::printf("%d allocation checks failed\n", failures);
+  return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,73 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+// Checks the pressure tables of a real gas against its equation of state.
+//
+// Over the default table range of 1 to 200 bar at 1024 nodes, the interpolated pressure of the
+// Papay gas has to match EquationOfState::pressure to a relative error of 1e-10, the derivative
+// of the interpolant to central differences of the equation of state to 1e-6, and the Jet
+// derivative of the interpolant to pressure_derivative to 1e-12.
+
+# include <phgasnets>
+
+# include <algorithm>
+# include <cmath>
+# include <cstdio>
+# include <memory>
+
+namespace {
+  int failures = 0;
+
+  void check(const char* what, const double error, const double tolerance) {
+    std::printf("%-42s largest relative error %.2e (tolerance %.0e)\n", what, error, tolerance);
+    if (!(error <= tolerance)) {
+      std::printf("  FAILED\n");
+      ++failures;
+    }
+  }
+}
+
+int main() {
+  const double gas_constant = 518.28;
+  const phgasnets::TableRange range;
+  const auto eos = std::make_shared<phgasnets::PapayGas>();
+
+  for (const double temperature : {276.25, 283.15, 320.0}) {
+    std::printf("T = %.2fK\n", temperature);
+    const phgasnets::PressureTable table(eos, gas_constant, temperature, range);
+
+    // Densities across the table, off its nodes
+    const int n_samples = 10007;
+    const double min_density = eos->density(range.min_pressure, temperature, gas_constant);
+    const double max_density = eos->density(range.max_pressure, temperature, gas_constant);
+
+    double pressure_error = 0.0, derivative_error = 0.0, jet_error = 0.0;
+    for (int i = 0; i < n_samples; ++i) {
+      const double rho = min_density + (max_density - min_density)*(i + 0.5)/n_samples;
+
+      const double exact = eos->pressure(rho, temperature, gas_constant);
+      pressure_error = std::max(pressure_error, std::abs(table.pressure(rho) - exact)/exact);
+
+      const double h = 1e-4*rho;
+      const double difference = (
+        eos->pressure(rho+h, temperature, gas_constant) - eos->pressure(rho-h, temperature, gas_constant)
+      ) / (2*h);
+      const double derivative = table.pressure_derivative(rho);
+      derivative_error = std::max(derivative_error, std::abs(derivative - difference)/std::abs(difference));
+
+      const auto jet = table.pressure(ceres::Jet<double, 1>(rho, 0));
+      jet_error = std::max(jet_error, std::abs(jet.v[0] - derivative)/std::abs(derivative));
+    }
+
+    check("pressure against the equation of state", pressure_error, 1e-10);
+    check("derivative against central differences", derivative_error, 1e-6);
+    check("Jet derivative against pressure_derivative", jet_error, 1e-12);
+  }
+
+  if (failures > 0)
+    std::printf("%d pressure table checks failed\n", failures);
+  return failures > 0 ? 1 : 0;
+}
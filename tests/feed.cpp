@@ -0,0 +1,101 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+// Stress test of the sequence locks of the live state feed, and of its size validation.
+//
+// A feed of only two slots receives 200000 publishes, while a reader thread reads as fast as
+// it can, such that the writer wraps onto slots being read all the time. Every state is filled
+// with its step index, so a torn read shows as mixed values within one copy. The test fails on
+// any torn read, and if a feed truncated below the size its header describes is not rejected.
+
+# include <phgasnets>
+
+# include <atomic>
+# include <cstdio>
+# include <stdexcept>
+# include <string>
+# include <thread>
+# include <vector>
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <unistd.h>
+
+namespace {
+  const std::string feed_name = "/phgasnets_check_feed_" + std::to_string(getpid());
+  const int n_publishes = 200000;
+}
+
+int main() {
+  std::vector<phgasnets::Compressor> compressors = {phgasnets::Compressor("FC", "AV", 1.2, 1.4)};
+  std::vector<phgasnets::Pipe> pipes = {
+    phgasnets::Pipe(181500, 1.422, 1.8e-3, 276.25),
+    phgasnets::Pipe(181500, 1.422, 1.8e-3, 276.25*compressors[0].temperature_scale)
+  };
+  const phgasnets::Network network(pipes, compressors, phgasnets::Fluid(530.0));
+  const auto discrete_network = phgasnets::discretize<double>(network, {{"resolution", 256}, {"order", 1}});
+
+  int failures = 0;
+  {
+    phgasnets::SharedStateFeed feed(feed_name, discrete_network, 2);
+    phgasnets::SharedStateFeedReader reader(feed_name);
+
+    std::atomic<bool> done{false};
+    long n_reads = 0, n_torn = 0;
+    std::thread reading([&] {
+      std::int64_t step;
+      double time;
+      Eigen::VectorXd state, pressure;
+      while (!done.load(std::memory_order_acquire)) {
+        if (!reader.read(step, time, state, pressure))
+          continue;
+        ++n_reads;
+
+        // State, time and pressure of one copy have to stem from the same publish
+        bool torn = (time != double(step)) || (state.array() != double(step)).any();
+        int pipe_pressure_startIdx = 0;
+        for (const auto& pipe : discrete_network.pipes) {
+          torn |= (pressure.segment(pipe_pressure_startIdx, pipe.n_rho).array() != pipe.pressure(double(step))).any();
+          pipe_pressure_startIdx += pipe.n_rho;
+        }
+        n_torn += torn;
+      }
+    });
+
+    Eigen::VectorXd state(discrete_network.n_state);
+    for (int step = 1; step <= n_publishes; ++step) {
+      state.setConstant(step);
+      feed.publish(step, step, state);
+    }
+    done.store(true, std::memory_order_release);
+    reading.join();
+
+    std::printf("%d publishes into 2 slots, %ld concurrent reads, %ld torn\n", n_publishes, n_reads, n_torn);
+    if (n_torn > 0) {
+      std::printf("FAILED: torn reads\n");
+      ++failures;
+    }
+
+    // Shrink the object below the slots its header describes
+    const int fd = shm_open(feed_name.c_str(), O_RDWR, 0);
+    const bool truncated = (fd >= 0) && (ftruncate(fd, 4096) == 0);
+    if (fd >= 0)
+      close(fd);
+    try {
+      phgasnets::SharedStateFeedReader truncated_reader(feed_name);
+      std::printf("FAILED: a truncated feed was accepted\n");
+      ++failures;
+    }
+    catch (const std::runtime_error& e) {
+      std::printf("truncated feed rejected: %s\n", e.what());
+    }
+    if (!truncated) {
+      std::printf("FAILED: cannot truncate the feed\n");
+      ++failures;
+    }
+  }
+
+  return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,96 @@
+// Copyright (C) 2024 Max Planck Institute for Dynamics of Complex Technical Systems, Magdeburg
+//
+// This file is part of phgasnets
+//
+// SPDX-License-Identifier:  GPL-3.0-or-later
+
+// Checks that a network restored from a snapshot discretizes to the same operators.
+//
+// A chain of four pipes at Nx=64 is written to a snapshot and restored. The pipes of the restored
+// network have to adopt Et and Jt without triplets, and its network operators E, J, R and G have
+// to equal those of the directly discretized chain exactly. A truncated snapshot has to be rejected,
+// and so have the operators for a network at another resolution.
+
+# include <phgasnets>
+
+# include <cstdio>
+# include <filesystem>
+# include <fstream>
+# include <stdexcept>
+# include <string>
+
+namespace {
+  int failures = 0;
+
+  void check(const char* what, const bool passed) {
+    std::printf("%-58s %s\n", what, passed ? "ok" : "FAILED");
+    if (!passed)
+      ++failures;
+  }
+
+  bool equal(const Eigen::SparseMatrix<double>& a, const Eigen::SparseMatrix<double>& b) {
+    return a.rows() == b.rows() && a.cols() == b.cols() && Eigen::MatrixXd(a - b).cwiseAbs().maxCoeff() == 0.0;
+  }
+}
+
+int main() {
+  const int Nx = 64;
+  const nlohmann::json spatial_disc_params = {{"resolution", Nx}, {"order", 1}};
+  const phgasnets::SyntheticChain chain(4, {{"gas_constant", 530.0}});
+
+  const std::string filename = (std::filesystem::temp_directory_path() / "phgasnets_check_snapshot.bin").string();
+  phgasnets::writeNetworkSnapshot(filename, chain.network, spatial_disc_params);
+
+  phgasnets::NetworkSnapshot snapshot(filename);
+  const phgasnets::Network network = snapshot.network();
+
+  auto assembled = phgasnets::discretize<double>(chain.network, spatial_disc_params);
+  auto adopted   = phgasnets::discretize<double>(network, spatial_disc_params);
+  const Eigen::VectorXd state = chain.initial_guess(Nx);
+  assembled.set_state(state);
+  adopted.set_state(state);
+
+  bool without_triplets = true;
+  for (const auto& pipe : adopted.pipes)
+    without_triplets = without_triplets && pipe.Et.data.empty() && pipe.Jt.data.empty();
+  check("pipes adopt Et and Jt without triplets", without_triplets);
+  check("E equals the assembled operator", equal(adopted.E, assembled.E));
+  check("J equals the assembled operator", equal(adopted.J, assembled.J));
+  check("R equals the assembled operator", equal(adopted.R, assembled.R));
+  check("G equals the assembled operator", equal(adopted.G, assembled.G));
+  check("effort equals the assembled effort", adopted.effort == assembled.effort);
+
+  // Other resolutions of the restored network are assembled
+  const nlohmann::json other_disc_params = {{"resolution", 2*Nx}, {"order", 1}};
+  auto refined = phgasnets::discretize<double>(network, other_disc_params);
+  check("other resolutions are assembled", refined.n_state == 4*(4*Nx+2) && !refined.pipes[0].Jt.data.empty());
+
+  std::vector<phgasnets::Pipe> pipes = chain.pipes;
+  std::vector<phgasnets::Compressor> compressors = chain.compressors;
+  phgasnets::Network other(pipes, compressors, phgasnets::Fluid(518.28));
+  bool rejected = false;
+  try {
+    snapshot.adoptOperators(other);
+  }
+  catch (const std::invalid_argument&) {
+    rejected = true;
+  }
+  check("operators of another network are rejected", rejected && !other.operators);
+
+  // Truncated within the operators of the last pipe
+  const auto size = std::filesystem::file_size(filename);
+  std::filesystem::resize_file(filename, size - 64);
+  rejected = false;
+  try {
+    phgasnets::NetworkSnapshot truncated(filename);
+  }
+  catch (const std::runtime_error&) {
+    rejected = true;
+  }
+  check("truncated snapshot is rejected", rejected);
+  std::filesystem::remove(filename);
+
+  if (failures > 0)
+    std::printf("%d snapshot checks failed\n", failures);
+  return failures > 0 ? 1 : 0;
+}